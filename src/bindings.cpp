@@ -17,7 +17,6 @@
 #include "pybind11/include/pybind11/pybind11.h"
 #include "pybind11/include/pybind11/chrono.h"
 #include "pybind11/include/pybind11/stl.h"
-#include "pybind11/include/pybind11/stl_bind.h"
 #endif
 
 #ifndef BLOCKCHAIN_CPP
@@ -47,15 +46,228 @@
 
 namespace py = pybind11;
 
-PYBIND11_MAKE_OPAQUE(std::map<std::string, Block *>);
+//! hash_from_py(string)
+/*! Convert a hash passed from Python into a raw hash. An empty string or "0" denote an unset hash.*/
+Hash256 hash_from_py(const std::string &hex)
+{ return (hex.empty() || hex == "0") ? Hash256() : Hash256::from_hex(hex); }
+
+//! LedgerHashIterator
+/*! Iterates over the block hashes of a LedgerView, in hexadecimal notation. Blocks appended
+while iterating are not reached.*/
+struct LedgerHashIterator {
+
+     LedgerView view;
+     uint64_t next;
+     uint64_t end;
+
+     LedgerHashIterator(const LedgerView &view)
+          : view(view), next(0), end(view.size())
+     {}
+};
+
+//! LedgerQueryIterator
+/*! Reads the blocks matched by a LedgerQuery through a LedgerCursor, one batch at a time. Yields
+either single blocks, taken from the current batch, or whole batches.*/
+struct LedgerQueryIterator {
+
+     LedgerCursor cursor;
+     std::vector<Block *> batch;
+     size_t next;
+     uint64_t batch_size;
+     bool batched;
+
+     LedgerQueryIterator(const LedgerQuery &query, uint64_t batch_size, bool batched)
+          : cursor(query.open()), next(0), batch_size(std::max(batch_size, (uint64_t) 1)), batched(batched)
+     {}
+};
+
+//! limit_from_py(object)
+/*! Convert a limit passed from Python into the maximum number of results. None denotes no limit.*/
+uint64_t limit_from_py(py::object limit)
+{ return limit.is_none() ? (uint64_t) -1 : limit.cast<uint64_t>(); }
+
+//! blocks_to_py(vector<Block *>, handle)
+/*! Convert blocks owned by a Blockchain object into a list of references, each of which keeps the
+Blockchain object alive.*/
+py::list blocks_to_py(const std::vector<Block *> &blocks, py::handle chain)
+{
+     py::list list;
+
+     for(size_t i = 0; i < blocks.size(); i++)
+          list.append(py::cast(blocks[i], py::return_value_policy::reference_internal, chain));
+
+     return list;
+}
+
+//! blocks_iter(LedgerView, object, object, object)
+/*! Iterate over the blocks of a ledger by height, with start, stop and step as for a Python slice.
+The blocks are taken from the ledger as they are reached, so this takes constant memory. The
+range is fixed when iteration starts; blocks appended later are not reached.*/
+py::iterator blocks_iter(const LedgerView &view, py::object start, py::object stop, py::object step)
+{
+     py::slice slice = py::reinterpret_steal<py::slice>(PySlice_New(start.ptr(), stop.ptr(), step.ptr()));
+     size_t first, last, stride, length;
+
+     if(!slice || !slice.compute(view.size(), &first, &last, &stride, &length)) throw py::error_already_set();
+
+     return py::make_iterator<py::return_value_policy::reference_internal>(
+          view.begin(first, (int64_t) stride), view.end(first, length, (int64_t) stride));
+}
+
+//! work_to_py(ChainWork)
+/*! Convert an amount of work into a Python integer, which holds it exactly.*/
+py::int_ work_to_py(const ChainWork &work)
+{ return py::reinterpret_steal<py::int_>(PyLong_FromString(work.to_hex().c_str(), NULL, 16)); }
 
 PYBIND11_MODULE(swiftchain, m)
 {
-     py::bind_map<std::map<std::string, Block *>>(m, "Ledger");
+     py::class_<LedgerHashIterator>(m, "LedgerHashIterator")
+          .def("__iter__", [](py::object self){ return self; })
+          .def("__next__", [](LedgerHashIterator &i)
+               {
+                    if(i.next == i.end) throw py::stop_iteration();
+                    return i.view.at(i.next++)->get_block_hash().to_hex();
+               });
+
+     py::class_<BlockTimeStats>(m, "BlockTimeStats")
+          .def_readonly("blocks", &BlockTimeStats::blocks, "The number of blocks covered.")
+          .def_readonly("intervals", &BlockTimeStats::intervals, "The number of times between consecutive blocks.")
+          .def_readonly("mean", &BlockTimeStats::mean, "The mean time between consecutive blocks in milliseconds.")
+          .def_readonly("min", &BlockTimeStats::min, "The smallest time between consecutive blocks in milliseconds.")
+          .def_readonly("max", &BlockTimeStats::max, "The largest time between consecutive blocks in milliseconds.");
+
+     py::class_<LedgerQueryIterator>(m, "LedgerQueryIterator")
+          .def("__iter__", [](py::object self){ return self; })
+          .def("__next__", [](py::object self) -> py::object
+               {
+                    LedgerQueryIterator &i = self.cast<LedgerQueryIterator &>();
+
+                    if(i.batched)
+                    {
+                         std::vector<Block *> batch = i.cursor.next_batch(i.batch_size);
+                         if(batch.empty()) throw py::stop_iteration();
+                         return blocks_to_py(batch, self);
+                    }
+
+                    if(i.next == i.batch.size())
+                    {
+                         i.batch = i.cursor.next_batch(i.batch_size);
+                         i.next = 0;
+                    }
+
+                    if(i.batch.empty()) throw py::stop_iteration();
+                    return py::cast(i.batch[i.next++], py::return_value_policy::reference_internal, self);
+               })
+          .def("plan", [](LedgerQueryIterator &i){ return py::make_tuple(i.cursor.get_plan(), i.cursor.get_candidates()); },
+               "Return the index being read and the number of candidate blocks it leaves.");
+
+     py::class_<LedgerQuery>(m, "LedgerQuery")
+          .def("meta", &LedgerQuery::meta, "Only match blocks carrying a metadata tag.",
+               py::arg("meta"), py::return_value_policy::reference_internal)
+          .def("node", &LedgerQuery::node, "Only match blocks mined by a node.",
+               py::arg("node_addr"), py::return_value_policy::reference_internal)
+          .def("heights", [](LedgerQuery &query, uint64_t first, py::object last) -> LedgerQuery &
+               { return query.heights(first, limit_from_py(last)); },
+               "Only match blocks with an ID from [first] up to [last]. None denotes the end of the ledger.",
+               py::arg("first"), py::arg("last") = py::none(), py::return_value_policy::reference_internal)
+          .def("time", [](LedgerQuery &query, uint64_t start, py::object end) -> LedgerQuery &
+               { return query.time(start, limit_from_py(end)); },
+               "Only match blocks with a timestamp from [start] up to [end] in UNIX milliseconds. \
+               None denotes no end.",
+               py::arg("start"), py::arg("end") = py::none(), py::return_value_policy::reference_internal)
+          .def("prefix", [](LedgerQuery &query, py::bytes prefix) -> LedgerQuery &
+               { return query.prefix(prefix); },
+               "Only match blocks whose data starts with [prefix].",
+               py::arg("prefix"), py::return_value_policy::reference_internal)
+          .def("prefix", &LedgerQuery::prefix, "Only match blocks whose data starts with [prefix].",
+               py::arg("prefix"), py::return_value_policy::reference_internal)
+          .def("reverse", &LedgerQuery::reverse, "Return the newest blocks first.",
+               py::arg("reverse") = true, py::return_value_policy::reference_internal)
+          .def("count", &LedgerQuery::count, "Return the number of blocks matched.")
+          .def("plan", [](LedgerQuery &query)
+               {
+                    LedgerCursor cursor = query.open();
+                    return py::make_tuple(cursor.get_plan(), cursor.get_candidates());
+               },
+               "Return the index the query would read and the number of candidate blocks it leaves.")
+          .def("first", [](LedgerQuery &query) { return query.open().next(); },
+               "Return the first block matched, None if there is none.", py::return_value_policy::reference_internal)
+          .def("__iter__", [](LedgerQuery &query){ return LedgerQueryIterator(query, 256, false); },
+               "Iterate over the blocks matched, reading them in batches of 256.", py::keep_alive<0, 1>())
+          .def("batches", [](LedgerQuery &query, uint64_t size){ return LedgerQueryIterator(query, size, true); },
+               "Iterate over the blocks matched as lists of at most [size] blocks.",
+               py::arg("size") = 256, py::keep_alive<0, 1>());
+
+     py::class_<LedgerView>(m, "LedgerView")
+          .def("__len__", &LedgerView::size)
+          .def("__getitem__", [](LedgerView &view, long int index)
+               {
+                    // Negative indices count from the end, as for Python lists:
+                    if(index < 0) index += (long int) view.size();
+                    if(index < 0) throw py::index_error("Requested index exceeds size of ledger.");
+
+                    try { return view.at((uint64_t) index); }
+                    catch(std::out_of_range &ex) { throw py::index_error(ex.what()); }
+               },
+               "Get the block at the given position, i.e. with the given block ID.",
+               py::arg("index"), py::return_value_policy::reference_internal)
+          .def("__getitem__", [](LedgerView &view, py::slice slice)
+               {
+                    size_t start, stop, step, length;
+                    std::vector<Block *> blocks;
+
+                    if(!slice.compute(view.size(), &start, &stop, &step, &length))
+                         throw py::error_already_set();
+
+                    for(size_t i = 0; i < length; i++, start += step) blocks.push_back(view.at(start));
+                    return blocks;
+               },
+               "Get a list of blocks by position.", py::arg("slice"), py::return_value_policy::reference_internal)
+          .def("__getitem__", [](LedgerView &view, std::string hash)
+               {
+                    Block *block = view.find(hash_from_py(hash));
+                    if(!block) throw py::key_error(hash);
+                    return block;
+               },
+               "Get a block by hash.", py::arg("hash"), py::return_value_policy::reference_internal)
+          .def("__contains__", [](LedgerView &view, std::string hash)
+               {
+                    // A string that is not a hash is not a key of the ledger either:
+                    try { return view.find(Hash256::from_hex(hash)) != NULL; }
+                    catch(std::invalid_argument &) { return false; }
+               },
+               py::arg("hash"))
+          .def("__iter__", [](LedgerView &view){ return LedgerHashIterator(view); },
+               "Iterate over the block hashes in ascending order of block ID.", py::keep_alive<0, 1>())
+          .def("keys", [](LedgerView &view){ return LedgerHashIterator(view); },
+               "Iterate over the block hashes in ascending order of block ID.", py::keep_alive<0, 1>())
+          .def("values", &blocks_iter,
+               "Iterate over the blocks in order of block ID, from [start] up to [stop] in steps of [step], \
+               as for a slice of a list.",
+               py::arg("start") = py::none(), py::arg("stop") = py::none(), py::arg("step") = py::none(),
+               py::keep_alive<0, 1>())
+          .def("items", [](py::object self)
+               {
+                    LedgerView &view = self.cast<LedgerView &>();
+                    py::list items;
+
+                    for(LedgerView::iterator i = view.begin(); i != view.end(); ++i)
+                         items.append(py::make_tuple((*i)->get_block_hash().to_hex(),
+                              py::cast(*i, py::return_value_policy::reference_internal, self)));
+                    return items;
+               },
+               "Get (hash, block) pairs in ascending order of block ID.");
+
+     py::class_<WorkerCoverage>(m, "WorkerCoverage")
+          .def_readonly("worker", &WorkerCoverage::worker, "The index of the worker.")
+          .def_readonly("hashes", &WorkerCoverage::hashes, "The number of nonces the worker has hashed.")
+          .def_readonly("ranges", &WorkerCoverage::ranges,
+               "The nonces the worker has hashed, as a list of half-open ranges (first, last).");
 
      py::class_<Block>(m, "Block")
-          .def(py::init<Block *, std::string, 
-               std::string, long unsigned int, long unsigned int, std::string, std::string>(),
+          .def(py::init([](Block *prev, std::string data, std::string user_addr, long unsigned int nonce,
+                           long unsigned int difficulty, std::string blockchain_id, std::string meta_data)
+               { return new Block(prev, data, user_addr, nonce, difficulty, hash_from_py(blockchain_id), meta_data); }),
                "Common Block constructor. Creates a block if given a previous block.",
                py::arg("prev"), py::arg("data"), py::arg("user_addr"),
                py::arg("nonce"), py::arg("difficulty"), py::arg("blockchain_id") = "0", 
@@ -68,14 +280,17 @@ PYBIND11_MODULE(swiftchain, m)
           .def("get_node_addr", &Block::get_node_address, 
                "Get the address of the node which mined this block.")
           .def("get_data", &Block::get_data, "Get the content stored in this Block.")
-          .def("get_block_hash", &Block::get_block_hash,
+          .def("get_block_hash", [](Block &block){ return block.get_block_hash().to_hex(); },
                "Return the hash of this Block.")
-          .def("get_prev_hash", &Block::get_prev_hash,
+          .def("get_prev_hash", [](Block &block)
+               { return block.get_block_id() ? block.get_prev_hash().to_hex() : std::string(); },
                "Return the previous hash that this Block stores.")
           .def("get_difficulty", &Block::get_difficulty,
                "Return the difficulty under which this Block was mined.")
           .def("get_nonce", &Block::get_nonce, 
                "Return the nonce with which this Block was mined.")
+          .def("get_timestamp", &Block::get_timestamp,
+               "Return the UNIX time in milliseconds at which this Block was mined.")
           .def("set_block_id", &Block::set_block_id, 
                "Set the unique ID of this block. \
                This function is mostly for internal use, as it may break the ledger.",
@@ -84,11 +299,20 @@ PYBIND11_MODULE(swiftchain, m)
                "Set the address that mined this block.", py::arg("node_addr"))
           .def("set_data", &Block::set_data, "Set the data stored within the block.",
                py::arg("data"))
-          .def("get_blockchain_id", &Block::get_blockchain_id,
+          .def("get_blockchain_id", [](Block &block){ return block.get_blockchain_id().to_hex(); },
                "Get the ID of the blockchain on which this block has mined.")
           .def("get_meta_data", &Block::get_meta_data, "Return the metadata stored in this block.")
+          .def("get_header", [](Block &block){ return py::bytes(block.get_header().serialize()); },
+               "Return the serialized header of this block, which the block hash is computed over.")
           .def("set_meta_data", &Block::set_meta_data, "Set the metadata stored in this block.",
-               py::arg("meta_data"));
+               py::arg("meta_data"))
+          .def("__eq__", [](Block &block, Block &other){ return block.get_block_hash() == other.get_block_hash(); },
+               "Blocks are equal if their hashes are, e.g. a block and its copy in another Blockchain.",
+               py::is_operator())
+          .def("__ne__", [](Block &block, Block &other){ return block.get_block_hash() != other.get_block_hash(); },
+               py::is_operator())
+          .def("__hash__", [](Block &block){ return std::hash<Hash256>()(block.get_block_hash()); },
+               "Hash a block by its block hash, which the setters do not change, so it matches __eq__.");
 
      py::class_<Node>(m, "Node")
           .def(py::init<std::string>(), py::arg("node_name"))
@@ -107,13 +331,45 @@ PYBIND11_MODULE(swiftchain, m)
                "Write data into the blockchain from a node.",
                py::arg("data"), py::arg("chain"), py::arg("max_tries") = 10,
                py::arg("meta_data") = "", py::arg("threads") = 1)
-          .def("read_data_by_meta", &Node::read_data_by_meta, 
-               "Find content by providing a metadata argument.", 
-               py::arg("meta"), py::arg("chain"))
+          .def("read_data_by_meta", [](Node &node, std::string meta, Blockchain *chain, uint64_t offset,
+                                       py::object limit, bool reverse)
+               { return node.read_data_by_meta(meta, chain, offset, limit_from_py(limit), reverse); },
+               "Find content by providing a metadata argument. \
+               Skips [offset] matches and returns at most [limit], newest first if [reverse] is set.",
+               py::arg("meta"), py::arg("chain"), py::arg("offset") = 0, py::arg("limit") = py::none(),
+               py::arg("reverse") = false)
           .def("get_block_by_index", &Node::get_block_by_index, "Get a block at a certain position in the ledger.",
-               py::arg("index"), py::arg("chain"), py::return_value_policy::move)
-          .def("get_blocks_by_meta", &Node::get_blocks_by_meta, "Get a range of blocks my providing a metadata argument.",
-               py::arg("meta"), py::arg("chain"));
+               py::arg("index"), py::arg("chain"), py::return_value_policy::reference, py::keep_alive<0, 3>())
+          .def("get_blocks_by_meta", [](Node &node, std::string meta, py::object chain, uint64_t offset,
+                                        py::object limit, bool reverse)
+               {
+                    return blocks_to_py(node.get_blocks_by_meta(meta, chain.cast<Blockchain *>(), offset,
+                                                                limit_from_py(limit), reverse), chain);
+               },
+               "Get a range of blocks my providing a metadata argument. \
+               Skips [offset] matches and returns at most [limit], newest first if [reverse] is set.",
+               py::arg("meta"), py::arg("chain"), py::arg("offset") = 0, py::arg("limit") = py::none(),
+               py::arg("reverse") = false)
+          .def("get_own_blocks", [](Node &node, py::object chain, uint64_t offset, py::object limit, bool reverse)
+               {
+                    return blocks_to_py(node.get_own_blocks(chain.cast<Blockchain *>(), offset,
+                                                            limit_from_py(limit), reverse), chain);
+               },
+               "Get the blocks this node has written into a chain, ordered by block ID. \
+               Skips [offset] blocks and returns at most [limit], newest first if [reverse] is set.",
+               py::arg("chain"), py::arg("offset") = 0, py::arg("limit") = py::none(), py::arg("reverse") = false)
+          .def("count_own_blocks", &Node::count_own_blocks,
+               "Get the number of blocks this node has written into a chain.", py::arg("chain"))
+          .def("get_blocks_by_time", [](Node &node, uint64_t start, uint64_t end, py::object chain, uint64_t offset,
+                                        py::object limit, bool reverse)
+               {
+                    return blocks_to_py(node.get_blocks_by_time(start, end, chain.cast<Blockchain *>(), offset,
+                                                                limit_from_py(limit), reverse), chain);
+               },
+               "Get the blocks with a timestamp from [start] up to [end] in UNIX milliseconds, ordered by block ID. \
+               Skips [offset] matches and returns at most [limit], newest first if [reverse] is set.",
+               py::arg("start"), py::arg("end"), py::arg("chain"), py::arg("offset") = 0,
+               py::arg("limit") = py::none(), py::arg("reverse") = false);
      
      py::class_<Blockchain>(m, "Blockchain")
           .def(py::init<long unsigned int, unsigned int, std::string, std::string, float>(),
@@ -122,23 +378,39 @@ PYBIND11_MODULE(swiftchain, m)
                py::arg("g_data") = "", py::arg("redux_time") = 0.5)
           .def("get_difficulty", &Blockchain::get_difficulty, 
                "Return the current difficulty to be satisfied in order to mine a block.")
-          .def("get_ledger", &Blockchain::get_ledger,
-               "Return the current ledger as a Ledger object.")
+          .def("get_ledger", &Blockchain::get_ledger_view,
+               "Return a read-only view of the current ledger, which does not copy it.", py::keep_alive<0, 1>())
+          .def("query", &Blockchain::query,
+               "Return a query over the ledger, to be narrowed down by filters and iterated lazily.",
+               py::keep_alive<0, 1>())
           .def("verify_block", &Blockchain::verify_block, 
                "Verify a current block against the entire blockchain.", py::arg("block"))
+          .def("verify_chain", &Blockchain::verify_chain,
+               "Verify the entire ledger from scratch. Returns true on success, false on failure.")
+          .def("validate_chain", [](Blockchain &chain, unsigned int threads)
+               {
+                    long int invalid = chain.validate_chain(threads);
+                    return (invalid < 0) ? py::object(py::none()) : py::object(py::int_(invalid));
+               },
+               "Validate every block in the ledger, including block hashes and proof-of-work, on several threads. \
+               Returns the ID of the first invalid block, None if the ledger is valid.",
+               py::arg("threads") = 0)
           .def("mine_block", &Blockchain::mine_block, 
                "Mine a block on a single CPU core. Returns None on failure, Block on success.",
-               py::arg("data"), py::arg("node_addr"), py::arg("meta_data") = "")
+               py::arg("data"), py::arg("node_addr"), py::arg("meta_data") = "",
+               py::return_value_policy::reference_internal)
           .def("mine_block_concurrently", &Blockchain::mine_block_concurrently, 
                "Mine a block in a parallelized manner. Returns None on failure, Block on success.",
-               py::arg("data"), py::arg("node_addr"), py::arg("meta_data") = "", py::arg("threads") = 5)
+               py::arg("data"), py::arg("node_addr"), py::arg("meta_data") = "", py::arg("threads") = 5,
+               py::return_value_policy::reference_internal)
           .def("find_consensus", &Blockchain::find_consensus, 
                "Find the Nakamoto consensus between two ledgers and replaces ledger \
                if foreign ledger possesses higher cumulative proof-of-work. \
                Returns ledger on success, None on failure.", py::arg("f_chain"))
-          .def("get_block", &Blockchain::get_block, "Get a block by hash.", py::arg("hash"))
+          .def("get_block", [](Blockchain &chain, std::string hash){ return chain.get_block(hash_from_py(hash)); },
+               "Get a block by hash.", py::arg("hash"), py::return_value_policy::reference_internal)
           .def("get_last_block", &Blockchain::get_last_block, "Get the last block in the ledger.", 
-               py::return_value_policy::reference)
+               py::return_value_policy::reference_internal)
           .def("set_diff_threshold", &Blockchain::set_difficulty_limit, 
                "Set the difficulty threshold. \
                (The number of blocks at which the difficulty is raised.)", 
@@ -151,22 +423,100 @@ PYBIND11_MODULE(swiftchain, m)
                "Set the difficulty of the blockchain.", py::arg("diff"))
           .def("get_ledger_size", &Blockchain::get_ledger_size,
                "Get the size of the current ledger.")
+          .def("get_cumulative_work", [](Blockchain &chain){ return work_to_py(chain.get_cumulative_work()); },
+               "Get the cumulative proof-of-work of the ledger, i.e. the sum of 2^difficulty over all blocks.")
           .def("get_try_limit", &Blockchain::get_try_limit, "Get the maximum number of tries per mining attempt.")
           .def("set_redux_time", &Blockchain::set_redux_time, 
                "Set the time after which the difficulty is decreased (in hours).",
                py::arg("hours"))
           .def("get_redux_time", &Blockchain::get_redux_time, 
                "Get the time after which the difficulty is decreased (in milliseconds).")
+          .def("count_by_meta", &Blockchain::count_by_meta, "Get the number of blocks per metadata tag, as a dict.")
+          .def("count_by_node", &Blockchain::count_by_node, "Get the number of blocks per node address, as a dict.")
+          .def("count_by_difficulty", &Blockchain::count_by_difficulty,
+               "Get the number of blocks per difficulty, as a dict.")
+          .def("histogram_by_time", [](Blockchain &chain, uint64_t bucket, uint64_t start, py::object end)
+               {
+                    try { return chain.histogram_by_time(bucket, start, limit_from_py(end)); }
+                    catch(std::invalid_argument &ex) { throw py::value_error(ex.what()); }
+               },
+               "Get the number of blocks per [bucket] milliseconds from [start] up to [end], as a dict keyed by \
+               the UNIX timestamp in milliseconds at which each bucket starts. Empty buckets are left out.",
+               py::arg("bucket"), py::arg("start") = 0, py::arg("end") = py::none())
+          .def("block_time_stats", [](Blockchain &chain, py::object window)
+               { return chain.block_time_stats(limit_from_py(window)); },
+               "Get statistics of the time between consecutive blocks among the newest [window] blocks, \
+               or all blocks if [window] is None.",
+               py::arg("window") = py::none())
+          .def("search_data", [](py::object self, std::string pattern, py::object limit, unsigned int threads,
+                                 bool reverse, std::string output) -> py::object
+               {
+                    Blockchain &chain = self.cast<Blockchain &>();
+
+                    if(output != "blocks" && output != "heights" && output != "hashes")
+                         throw py::value_error("output must be \"blocks\", \"heights\" or \"hashes\".");
+
+                    std::vector<uint64_t> heights = chain.search_data(pattern, limit_from_py(limit), threads, reverse);
+                    if(output == "heights") return py::cast(heights);
+
+                    LedgerView view = chain.get_ledger_view();
+                    std::vector<Block *> blocks(heights.size());
+                    for(size_t i = 0; i < heights.size(); i++) blocks[i] = view.at(heights[i]);
+
+                    if(output == "blocks") return blocks_to_py(blocks, self);
+
+                    py::list hashes;
+                    for(size_t i = 0; i < blocks.size(); i++) hashes.append(blocks[i]->get_block_hash().to_hex());
+                    return hashes;
+               },
+               "Find the blocks whose data contains [pattern], given as str or bytes, searching on [threads] threads \
+               (0 for one per hardware thread). Stops after [limit] matches, starting at the newest block if \
+               [reverse] is set. Returns the blocks, or their IDs or hashes if [output] is \"heights\" or \"hashes\".",
+               py::arg("pattern"), py::arg("limit") = py::none(), py::arg("threads") = 0, py::arg("reverse") = false,
+               py::arg("output") = "blocks")
+          .def("iter_blocks", [](Blockchain &chain, py::object start, py::object stop, py::object step)
+               { return blocks_iter(chain.get_ledger_view(), start, stop, step); },
+               "Iterate over the blocks in order of block ID, from [start] up to [stop] in steps of [step], \
+               as for a slice of a list. Takes constant memory and is not disturbed by blocks being appended.",
+               py::arg("start") = py::none(), py::arg("stop") = py::none(), py::arg("step") = py::none(),
+               py::keep_alive<0, 1>())
           .def("get_blocks_by_range", &Blockchain::get_blocks_by_range,
                "Get [range] number of blocks from ledger, in ascending order.", 
-               py::arg("range"), py::return_value_policy::copy)
-          .def("get_blockchain_id", &Blockchain::get_blockchain_id, 
+               py::arg("range"), py::return_value_policy::reference_internal)
+          .def("get_blocks_by_meta", [](Blockchain &chain, std::string meta, uint64_t offset, py::object limit,
+                                        bool reverse)
+               { return chain.get_blocks_by_meta(meta, offset, limit_from_py(limit), reverse); },
+               "Get the blocks carrying a metadata tag, ordered by block ID. \
+               Skips [offset] matches and returns at most [limit], newest first if [reverse] is set.",
+               py::arg("meta"), py::arg("offset") = 0, py::arg("limit") = py::none(), py::arg("reverse") = false,
+               py::return_value_policy::reference_internal)
+          .def("count_blocks_by_meta", &Blockchain::count_blocks_by_meta,
+               "Get the number of blocks carrying a metadata tag.", py::arg("meta"))
+          .def("get_blocks_by_node", [](Blockchain &chain, std::string node_addr, uint64_t offset, py::object limit,
+                                        bool reverse)
+               { return chain.get_blocks_by_node(node_addr, offset, limit_from_py(limit), reverse); },
+               "Get the blocks mined by a node, ordered by block ID. \
+               Skips [offset] matches and returns at most [limit], newest first if [reverse] is set.",
+               py::arg("node_addr"), py::arg("offset") = 0, py::arg("limit") = py::none(), py::arg("reverse") = false,
+               py::return_value_policy::reference_internal)
+          .def("count_blocks_by_node", &Blockchain::count_blocks_by_node,
+               "Get the number of blocks mined by a node.", py::arg("node_addr"))
+          .def("get_blocks_by_time", [](Blockchain &chain, uint64_t start, uint64_t end, uint64_t offset,
+                                        py::object limit, bool reverse)
+               { return chain.get_blocks_by_time(start, end, offset, limit_from_py(limit), reverse); },
+               "Get the blocks with a timestamp from [start] up to [end] in UNIX milliseconds, ordered by block ID. \
+               Skips [offset] matches and returns at most [limit], newest first if [reverse] is set.",
+               py::arg("start"), py::arg("end"), py::arg("offset") = 0, py::arg("limit") = py::none(),
+               py::arg("reverse") = false, py::return_value_policy::reference_internal)
+          .def("get_blockchain_id", [](Blockchain &chain){ return chain.get_blockchain_id().to_hex(); },
                "Get the identifying hash of this blockchain.")
           .def("get_block_by_index", &Blockchain::get_block_by_index, "Get a block at a certain position in the ledger.",
-               py::arg("index"));
+               py::arg("index"), py::return_value_policy::reference_internal)
+          .def("get_mining_coverage", &Blockchain::get_mining_coverage,
+               "Get the nonces each worker has hashed during the last mining attempt, one WorkerCoverage per worker.");
      
           m.def("find_trailing_zeros", &find_trailing_zeros,
-               "Find the number of trailing zeros in a hash.",
+               "Find the number of zeros at the start of a hash in binary notation.",
                py::arg("hash"))
           .def("convert_to_bin", &convert_to_bin,
                "Convert a hexadecimal string to a binary string.",
@@ -180,5 +530,37 @@ PYBIND11_MODULE(swiftchain, m)
                py::arg("block"))
           .def("generate_sha_hash", &generate_sha_hash,
                "Generate a SHA256 hash from a given string.",
-               py::arg("data"));
+               py::arg("data"))
+          .def("set_hash_engine", &set_hash_engine,
+               "Force the SHA256 implementation used for mining and verification. \
+               Pass \"auto\" to select the fastest one again. Raises ValueError if it is not supported.",
+               py::arg("engine"))
+          .def("get_hash_engine", &get_hash_engine,
+               "Return the name of the SHA256 implementation in use.")
+          .def("get_hash_engines", &get_hash_engines,
+               "Return the names of all SHA256 implementations this CPU supports.")
+          .def("cross_check_hash_engines", &cross_check_hash_engines,
+               "Check every supported SHA256 implementation against PicoSHA2. \
+               Returns a dict mapping each implementation to the result.")
+          .def("set_pool_size", &set_pool_size,
+               "Set the number of threads of the worker pool shared by all blockchains. \
+               0 stops the pool, after which threads are started for every block instead.",
+               py::arg("size"))
+          .def("get_pool_size", &get_pool_size,
+               "Return the number of threads of the worker pool.")
+          .def("benchmark_block_memory", &benchmark_block_memory,
+               "Create blocks as the ledger holds them and measure the memory they take. \
+               Returns the heap memory per block, the payload size and sizeof(Block) in bytes.",
+               py::arg("blocks") = 100000, py::arg("data_size") = 256)
+          .def("benchmark_hash_index", &benchmark_hash_index,
+               "Time random lookups in the hash index used by the ledger against std::map. \
+               Returns the mean time of a lookup in nanoseconds for each, and the bytes per entry of the index.",
+               py::arg("entries") = 1000000, py::arg("lookups") = 1000000)
+          .def("cross_check_hash_index", &cross_check_hash_index,
+               "Check the hash index used by the ledger against std::map while it grows, \
+               including duplicate hashes and hashes that share a slot. Returns a dict mapping each check to the result.",
+               py::arg("entries") = 100000);
+
+     // Select the hash engine on import, so a bad SWIFTCHAIN_HASH_ENGINE is reported right away:
+     sha256_engine();
 }
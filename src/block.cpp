@@ -17,6 +17,11 @@
 #include "block.hpp"
 #endif
 
+#ifndef BLOCK_ARENA_HEADER
+#define BLOCK_ARENA_HEADER
+#include "block_arena.hpp"
+#endif
+
 #ifndef HASH_HEADER
 #define HASH_HEADER
 #include "hashing_util.hpp"
@@ -36,22 +41,44 @@ difficulty: The current difficulty level.
 This is the common constructor used for mining blocks.*/
 Block::Block(Block *prev, string data, string userAddress,
             long unsigned int nonce, long unsigned int difficulty,
-            string blockchain_id = "0", string meta_data = "")
+            Hash256 blockchain_id = Hash256(), string meta_data = "")
 {
     /* Common constructor. Used in mining blocks, for e.g. data storage.*/
 
-    this->block_id = (*prev).block_id + 1;
+    this->arena = NULL;
+    this->copy_data(data.data(), data.size());
+    this->node_address = new string(userAddress);
+    this->blockchain_id = new Hash256(blockchain_id);
+    this->meta_data = new string(meta_data);
+
+    this->init_header(prev, nonce, difficulty, generate_timestamp());
+    this->block_hash = generate_block_hash();
+}
+
+//! Construct a Block object from a finished header
+/*! Parameters:
+
+header: A header whose payload digest matches the payload below, as built by make_header.
+data, data_size: The data of the Block, which has to outlive the Block object. It is not copied.
+userAddress, meta_data: The rest of the payload of the Block, interned by the caller.
+blockchain_id: The ID of the blockchain the Block is mined on, interned by the caller.
+arena: The BlockArena owning the Block object.
+
+Used by BlockArena, which places the data right behind the Block object and owns the interned
+values. The payload is not hashed again.*/
+Block::Block(const BlockHeader &header, const char *data, uint64_t data_size,
+             const string *userAddress, const Hash256 *blockchain_id, const string *meta_data,
+             BlockArena *arena)
+{
+    this->header = header;
     this->data = data;
+    this->data_size = data_size;
+    this->arena = arena;
     this->node_address = userAddress;
-    this->timestamp = generate_timestamp();
     this->blockchain_id = blockchain_id;
     this->meta_data = meta_data;
 
-    this->difficulty = difficulty;
-    this->nonce = nonce;
-
-    this->prev_hash = prev->get_block_hash();
-    this->block_hash = generate_block_hash(this);
+    this->block_hash = generate_block_hash();
 }
 
 //! Construct a Genesis block
@@ -66,125 +93,359 @@ Block::Block(string data, string node_address)
 {
     /* Genesis constructor.*/
 
-    this->block_id = 0;
-    this->data = data;
-    this->node_address = node_address;
+    this->arena = NULL;
+    this->copy_data(data.data(), data.size());
+    this->node_address = new string(node_address);
+    this->blockchain_id = new Hash256();
+    this->meta_data = new string("GENESIS");
+
+    this->init_header(NULL, 0, 0, generate_timestamp());
+    this->block_hash = generate_block_hash();
+}
+
+//! Copy a Block object. The copy owns a copy of the data and of the tags.
+Block::Block(const Block &other)
+{
+    this->arena = NULL;
+    this->data = NULL;
+    this->node_address = this->meta_data = NULL;
+    this->blockchain_id = NULL;
+    *this = other;
+}
+
+//! Destroy a Block object, releasing its data and tags unless they are owned by a BlockArena.
+Block::~Block()
+{ this->release_payload(); }
+
+//! operator=(Block)
+/*! Copies another Block object. The data and the tags are copied, so the copy does not depend on
+where those of the other Block object live. The Block object owns its payload afterwards.*/
+Block &Block::operator=(const Block &other)
+{
+    if(this == &other) return *this;
+
+    this->release_payload();
+    this->arena = NULL;
+
+    this->copy_data(other.data, other.data_size);
+    this->node_address = new string(*other.node_address);
+    this->meta_data = new string(*other.meta_data);
+    this->blockchain_id = new Hash256(*other.blockchain_id);
 
-    this->timestamp = generate_timestamp();
-    this->difficulty = 0;
-    this->nonce = 0;
-    this->meta_data = "GENESIS";
+    this->header = other.header;
+    this->block_hash = other.block_hash;
 
-    this->prev_hash = "";
+    return *this;
+}
+
+//! copy_data(const char *, uint64_t)
+/*! Parameters: Some data and its size.
+Points the data of this Block object to a copy owned by the Block object. The previous data is not released.*/
+void Block::copy_data(const char *data, uint64_t size)
+{
+    char *copy = new char[size];
+    memcpy(copy, data, size);
+
+    this->data = copy;
+    this->data_size = size;
+}
+
+//! init_header(Block *, long unsigned int, long unsigned int, uint64_t)
+/*! Parameters: The previous Block object (NULL for Genesis), the nonce, the difficulty and the timestamp.
+Fills in the header of this Block object, including the digest of its payload.*/
+void Block::init_header(Block *prev, long unsigned int nonce, long unsigned int difficulty,
+                        uint64_t timestamp)
+{
+    this->header = make_header(prev, *this->node_address, *this->meta_data, this->data,
+                               this->data_size, nonce, difficulty, timestamp);
+}
+
+//! make_header(Block *, string, string, const char *, uint64_t, long unsigned int, long unsigned int, uint64_t)
+/*! Parameters: The previous Block object (NULL for Genesis), the payload, the nonce, the difficulty
+and the timestamp.
+Returns the header of a Block object with the given attributes, including the digest of its payload.*/
+BlockHeader Block::make_header(Block *prev, const string &node_address, const string &meta_data,
+                               const char *data, uint64_t data_size, long unsigned int nonce,
+                               long unsigned int difficulty, uint64_t timestamp)
+{
+    BlockHeader header;
 
-    this->block_hash = generate_block_hash(this);
+    header.version = BLOCK_HEADER_VERSION;
+    header.difficulty = (uint32_t) difficulty;
+    header.height = prev ? prev->header.height + 1 : 0;
+    header.timestamp = timestamp;
+    header.nonce = nonce;
+
+    // The Genesis block has an all-zero previous hash:
+    header.prev_hash = prev ? prev->block_hash : Hash256();
+
+    hash_payload(node_address, meta_data, data, data_size, header.payload_hash);
+    return header;
 }
 
 //! generate_timestamp(void)
 /*! Parameters: None
-Returns a UNIX timestamp as a string. */
-string Block::generate_timestamp()
+Returns a UNIX timestamp in milliseconds. */
+uint64_t Block::generate_timestamp()
+{
+    std::chrono::system_clock::duration now = std::chrono::system_clock::now().time_since_epoch();
+    return (uint64_t) std::chrono::duration_cast<std::chrono::milliseconds>(now).count();
+}
+
+//! append_be64(string &, uint64_t)
+/*! Append a 64 bit integer to a serialization buffer in big-endian order.*/
+static void append_be64(string &buffer, uint64_t x)
 {
-    std::chrono::system_clock::time_point now = std::chrono::system_clock::now();
-    std::time_t now_c = std::chrono::system_clock::to_time_t(now);
+    for(int i = 7; i >= 0; i--) buffer += (char) (x >> (8 * i));
+}
 
-    return string(to_string(now_c));
+//! append_field(string &, const char *, uint64_t)
+/*! Append a length-prefixed field to a serialization buffer.*/
+static void append_field(string &buffer, const char *field, uint64_t size)
+{
+    append_be64(buffer, size);
+    buffer.append(field, size);
 }
 
-//! generate_block_hash(Block *)
-/*! Parameters: Some Block object to be hashed.
-Generate a SHA256 hash string from a given Block object.*/
-string Block::generate_block_hash(Block *b)
+//! hash_payload(string, string, const char *, uint64_t, Hash256 &)
+/*! Parameters: The node address, metadata and data of a Block object, and the digest to be written.
+Computes the payload digest that the block header commits to. Each field is prefixed by its length
+as an 8 byte big-endian integer.*/
+void Block::hash_payload(const string &node_address, const string &meta_data,
+                         const char *data, uint64_t data_size, Hash256 &out)
 {
-    // Turn the attributes of the Block object into a single string:
-    string seed = b->data + b->node_address + b->timestamp +
-                    to_string(b->difficulty) + to_string(b->nonce) +
-                    b->prev_hash + b->blockchain_id + to_string(b->block_id)
-                    + b->meta_data; 
+    string buffer;
+    buffer.reserve(24 + node_address.size() + meta_data.size() + data_size);
+
+    append_field(buffer, node_address.data(), node_address.size());
+    append_field(buffer, meta_data.data(), meta_data.size());
+    append_field(buffer, data, data_size);
 
-    // Return the hash of the assembled string:
-    return generate_sha_hash(seed);
+    sha256_hash((const unsigned char *) buffer.data(), buffer.size(), out);
 }
 
+//! serialize(unsigned char *)
+/*! Parameters: A buffer of BLOCK_HEADER_SIZE bytes.
+Writes the canonical serialization of the header, with the nonce coming last. Since the nonce sits
+in the second 64 byte block, the SHA256 state over the first block can be computed once and reused
+for every nonce while mining.*/
+void BlockHeader::serialize(unsigned char *out) const
+{
+    store_be32(out, this->version);
+    store_be32(out + 4, this->difficulty);
+    store_be32(out + 8, (uint32_t) (this->height >> 32));
+    store_be32(out + 12, (uint32_t) this->height);
+    store_be32(out + 16, (uint32_t) (this->timestamp >> 32));
+    store_be32(out + 20, (uint32_t) this->timestamp);
+    memcpy(out + 24, this->prev_hash.bytes, 32);
+    memcpy(out + 56, this->payload_hash.bytes, 32);
+    store_be32(out + BLOCK_HEADER_NONCE_OFFSET, (uint32_t) (this->nonce >> 32));
+    store_be32(out + BLOCK_HEADER_NONCE_OFFSET + 4, (uint32_t) this->nonce);
+}
+
+//! serialize(void)
+/*! Returns the canonical serialization of the header as a string of BLOCK_HEADER_SIZE bytes.*/
+string BlockHeader::serialize() const
+{
+    unsigned char buffer[BLOCK_HEADER_SIZE];
+    this->serialize(buffer);
+
+    return string((const char *) buffer, BLOCK_HEADER_SIZE);
+}
+
+//! hash(void)
+/*! Returns the block hash, i.e. the SHA256 hash of the serialized header, computed by the hash engine in use.*/
+Hash256 BlockHeader::hash() const
+{
+    Hash256 out;
+    unsigned char buffer[BLOCK_HEADER_SIZE];
+    this->serialize(buffer);
+
+    sha256_hash(buffer, BLOCK_HEADER_SIZE, out);
+    return out;
+}
+
+//! generate_block_hash(void)
+/*! Parameters: None
+Generate a SHA256 hash from the header of this Block object.*/
+Hash256 Block::generate_block_hash()
+{ return this->header.hash(); }
+
+//! verify_hashes(void)
+/*! Parameters: None
+Recomputes the digest of the payload and the block hash. Returns true if the header commits to the
+payload and the stored block hash is the hash of the header, else returns false.*/
+bool Block::verify_hashes()
+{
+    Hash256 payload_hash;
+    hash_payload(*this->node_address, *this->meta_data, this->data, this->data_size, payload_hash);
+
+    return payload_hash == this->header.payload_hash && this->header.hash() == this->block_hash;
+}
+
+//! get_header(void)
+/*! Parameters: None
+Get the header of the Block object, which the block hash is computed over.*/
+const BlockHeader &Block::get_header()
+{ return this->header; }
+
 //! get_block_id(void)
 /*! Parameters: None
 Returns the unique ID of the Block object as an integer.*/
 long unsigned int Block::get_block_id()
-{ return this->block_id; }
+{ return this->header.height; }
 
 //! get_data(void)
 /*! Parameters: None
 Get the content contained within the Block object. */
 string Block::get_data()
+{ return string(this->data, this->data_size); }
+
+//! get_data_pointer(void)
+/*! Parameters: None
+Get the content contained within the Block object without copying it. The pointer stays valid
+until the content is replaced or the Block object is destroyed.*/
+const char *Block::get_data_pointer()
 { return this->data; }
 
+//! get_data_size(void)
+/*! Parameters: None
+Get the size of the content contained within the Block object in bytes.*/
+uint64_t Block::get_data_size()
+{ return this->data_size; }
+
 //! get_block_hash(void)
 /*! Parameters: None
 Get the hash of the Block object.*/
-string Block::get_block_hash()
+Hash256 Block::get_block_hash()
 { return this->block_hash; }
 
 //! get_prev_hash(void)
 /*! Parameters: None
-Get the previous hash stored within in Block object. */
-string Block::get_prev_hash()
-{ return this->prev_hash; }
+Get the previous hash stored within in Block object. The Genesis block stores an all-zero hash.*/
+Hash256 Block::get_prev_hash()
+{ return this->header.prev_hash; }
 
 //! get_difficulty(void)
 /*! Parameters: None
 Get the difficulty level under which the current block was mined.*/
 long unsigned int Block::get_difficulty()
-{ return this->difficulty; }
+{ return this->header.difficulty; }
 
 //! get_nonce(void)
 /*! Parameters: None
 Return the nonce with which the Block object was mined.*/
 long int Block::get_nonce()
-{ return this->nonce; }
+{ return this->header.nonce; }
 
 //! set_block_id(long unsigned int)
 /*! Parameters: A unique integer to be used as a block identifier.*/
 void Block::set_block_id(long unsigned int block_id)
-{ this->block_id = block_id; }
+{ this->header.height = block_id; }
 
-//! set_blockchain_id(string)
-/*! Parameters: A blockchain ID as a string.
+//! set_blockchain_id(Hash256)
+/*! Parameters: A blockchain ID, i.e. the hash of a Genesis block.
 Specify a blockchain which this Block object is contained with.*/
-void Block::set_blockchain_id(string blockchain_id)
-{ this->blockchain_id = blockchain_id; }
+void Block::set_blockchain_id(Hash256 blockchain_id)
+{
+    if(this->arena)
+    {
+        this->arena->set_blockchain_id(this, blockchain_id);
+        return;
+    }
+
+    delete this->blockchain_id;
+    this->blockchain_id = new Hash256(blockchain_id);
+}
 
 //! set_node_address(string)
 /*! Parameters: A Node address as a string.
-Set the Node address associated with this Block object.*/
+Set the Node address associated with this Block object. The index of the ledger holding the block
+follows the change.*/
 void Block::set_node_address(string node_address)
-{ this->node_address = node_address; }
+{
+    if(this->arena)
+    {
+        this->arena->set_tags(this, node_address, *this->meta_data);
+        return;
+    }
+
+    delete this->node_address;
+    this->node_address = new string(node_address);
+}
 
 //! get_node_address(void)
 /*! Parameters: None
 Get the address of the node that mined this block.*/
 string Block::get_node_address()
+{ return *this->node_address; }
+
+//! get_node_tag(void)
+/*! Parameters: None
+Get the interned address of the node that mined this block. Blocks of a chain mined by the same node return the same pointer.*/
+const string *Block::get_node_tag()
 { return this->node_address; }
 
 //! get_timestamp(void)
 /*! Parameters: None
-Get the UNIX timestamp contained within this string*/
-string Block::get_timestamp()
-{ return this->timestamp; }
+Get the UNIX timestamp in milliseconds contained within this Block object as an integer.*/
+uint64_t Block::get_timestamp()
+{ return this->header.timestamp; }
 
 //! get_blockchain_id(void)
 /*! Get the ID of the blockchain associated with this Block object. */
-string Block::get_blockchain_id()
-{ return this->blockchain_id; }
+Hash256 Block::get_blockchain_id()
+{ return *this->blockchain_id; }
 
 //! set_data(string)
 /*! Set the content of this Block object.*/
 void Block::set_data(string data)
-{ this->data = data; }
+{
+    if(this->arena)
+    {
+        this->arena->set_data(this, data.data(), data.size());
+        return;
+    }
+
+    const char *old_data = this->data;
+
+    this->copy_data(data.data(), data.size());
+    delete[] old_data;
+}
 
 //! get_meta_data(void)
 /*! Get the meta data stored within the Block object*/
 string Block::get_meta_data()
+{ return *this->meta_data; }
+
+//! get_meta_tag(void)
+/*! Get the interned meta data of the Block object. Blocks of a chain carrying the same meta data return the same pointer.*/
+const string *Block::get_meta_tag()
 { return this->meta_data; }
 
+//! set_meta_data(string)
+/*! Set the meta data stored within the Block object. The index of the ledger holding the block
+follows the change.*/
 void Block::set_meta_data(string meta_data)
-{ this->meta_data = meta_data; }
\ No newline at end of file
+{
+    if(this->arena)
+    {
+        this->arena->set_tags(this, *this->node_address, meta_data);
+        return;
+    }
+
+    delete this->meta_data;
+    this->meta_data = new string(meta_data);
+}
+
+//! release_payload(void)
+/*! Deletes the data, node address, meta data and blockchain ID unless they are owned by a BlockArena.*/
+void Block::release_payload()
+{
+    if(this->arena) return;
+
+    delete[] this->data;
+    delete this->node_address;
+    delete this->meta_data;
+    delete this->blockchain_id;
+}
@@ -17,10 +17,52 @@
 
 #include <vector>
 #include <cstdlib>
+#include <stdint.h>
 #include <chrono>
 
 #include "./PicoSHA2/picosha2.h"
 
+#ifndef SIMD_HASH_HEADER
+#define SIMD_HASH_HEADER
+#include "simd_hash_util.hpp"
+#endif
+
+#ifndef INTERN_POOL_HEADER
+#define INTERN_POOL_HEADER
+#include "intern_pool.hpp"
+#endif
+
+// Version of the block header. Version 1 hashed a variable-length serialization of the whole block.
+#define BLOCK_HEADER_VERSION 2
+
+// Size of a serialized header in bytes and the offset of the nonce, which comes last:
+#define BLOCK_HEADER_SIZE 96
+#define BLOCK_HEADER_NONCE_OFFSET 88
+
+class BlockArena;
+
+//! BlockHeader
+/*! The fixed-size part of a block that the block hash and the proof-of-work are computed over.
+The payload (data, metadata and node address) is committed to by its digest, so hashing and verifying
+a header costs the same regardless of the size of the payload.
+
+Serialized layout (big-endian): version (4), difficulty (4), height (8), timestamp (8),
+prev_hash (32), payload_hash (32), nonce (8).*/
+struct BlockHeader {
+
+    uint32_t version;
+    uint32_t difficulty;
+    uint64_t height;
+    uint64_t timestamp;
+    Hash256 prev_hash;
+    Hash256 payload_hash;
+    uint64_t nonce;
+
+    void serialize(unsigned char *out) const;
+    std::string serialize() const;
+    Hash256 hash() const;
+};
+
 //! Block
 /*! This class implements a block structure which may be mined using the mineBlock function 
 from the Blockchain class. It provides two constructors, one Genesis constructor and 
@@ -31,26 +73,31 @@ class Block {
 
     private:
 
-        // Primitive Block Attributes:
-        long unsigned int block_id;
-        long int nonce;
-        long unsigned int difficulty;
+        // Header, which the block hash is computed over:
+        BlockHeader header;
 
-        // Block Metadata
-        std::string node_address;
-        std::string timestamp;
-        std::string meta_data;
+        // Block Payload. Node addresses and metadata tags repeat across blocks and are interned
+        // by the BlockArena which created the block, which also holds the data; other blocks own them:
+        const std::string *node_address;
+        const std::string *meta_data;
+        const char *data;
+        uint64_t data_size;
 
-        std::string data;
+        // The BlockArena owning this block, NULL if the block owns its payload. Changes to the
+        // payload of an arena's block go through the arena, so the ledger indexes follow them:
+        BlockArena *arena;
 
-        // Relevant Hashes:
-        std::string block_hash;
-        std::string prev_hash;
+        // Relevant Hashes. The blockchain ID is the same for every block of a chain:
+        Hash256 block_hash;
+        const Hash256 *blockchain_id;
 
-        std::string blockchain_id;
+        void init_header(Block *prev, long unsigned int nonce, long unsigned int difficulty,
+                         uint64_t timestamp);
+        void copy_data(const char *data, uint64_t size);
+        void release_payload();
+        Hash256 generate_block_hash();
 
-        std::string generate_block_hash(Block *b);
-        std::string generate_timestamp();
+        friend class BlockArena;
 
     protected:
     public:
@@ -58,24 +105,46 @@ class Block {
         Block(std::string data, std::string user_address);
         Block(Block *prev, std::string data, std::string user_address, 
               long unsigned int nonce, long unsigned int difficulty,
-              std::string blockchain_id, std::string meta_data);
+              Hash256 blockchain_id, std::string meta_data);
+        Block(const BlockHeader &header, const char *data, uint64_t data_size,
+              const std::string *user_address, const Hash256 *blockchain_id, const std::string *meta_data,
+              BlockArena *arena);
+        Block(const Block &other);
+        ~Block();
+
+        Block &operator=(const Block &other);
+
+        static uint64_t generate_timestamp();
+        static BlockHeader make_header(Block *prev, const std::string &node_address,
+                                       const std::string &meta_data, const char *data,
+                                       uint64_t data_size, long unsigned int nonce,
+                                       long unsigned int difficulty, uint64_t timestamp);
+        static void hash_payload(const std::string &node_address, const std::string &meta_data,
+                                 const char *data, uint64_t data_size, Hash256 &out);
 
         void set_node_address(std::string node_address);
         void set_block_id(long unsigned int block_id);
-        void set_blockchain_id(std::string blockchain_id);
+        void set_blockchain_id(Hash256 blockchain_id);
         void set_data(std::string data);
         void set_meta_data(std::string meta_data);
 
-        std::string get_block_hash();
-        std::string get_prev_hash();
+        bool verify_hashes();
+
+        const BlockHeader &get_header();
+        Hash256 get_block_hash();
+        Hash256 get_prev_hash();
         long int get_nonce();
         long unsigned int get_block_id();
         long unsigned int get_difficulty();
         std::string get_data();
+        const char *get_data_pointer();
+        uint64_t get_data_size();
         std::string get_node_address();   
-        std::string get_blockchain_id();
-        std::string get_timestamp();
+        const std::string *get_node_tag();
+        Hash256 get_blockchain_id();
+        uint64_t get_timestamp();
         std::string get_meta_data();
+        const std::string *get_meta_tag();
 
 };
 
@@ -0,0 +1,217 @@
+// Copyright 2020 Falk Spickenbaum
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef BLOCK_ARENA_HEADER
+#define BLOCK_ARENA_HEADER
+#include "block_arena.hpp"
+#endif
+
+#ifndef LEDGER_STORE_HEADER
+#define LEDGER_STORE_HEADER
+#include "ledger_store.hpp"
+#endif
+
+#ifndef HASH_HEADER
+#define HASH_HEADER
+#include "hashing_util.hpp"
+#endif
+
+#include <new>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+//! Construct an empty BlockArena object
+BlockArena::BlockArena()
+{
+    this->chunk_used = 0;
+    this->chunk_size = 0;
+    this->bytes = 0;
+    this->ledger = NULL;
+}
+
+//! Destroy a BlockArena object and all blocks it owns
+BlockArena::~BlockArena()
+{
+    for(uint64_t i = 0; i < this->blocks.size(); i++) this->blocks[i]->~Block();
+    for(uint64_t i = 0; i < this->chunks.size(); i++) delete[] this->chunks[i];
+}
+
+//! allocate(uint64_t)
+/*! Parameters: A number of bytes.
+Returns memory for a Block object and its data, aligned for a Block object.*/
+void *BlockArena::allocate(uint64_t size)
+{
+    // Keep every allocation aligned for the next Block object:
+    size = (size + alignof(Block) - 1) / alignof(Block) * alignof(Block);
+
+    if(this->chunks.empty() || this->chunk_used + size > this->chunk_size)
+    {
+        // A block larger than a chunk gets a chunk of its own, after which the
+        // arena continues on a fresh chunk:
+        uint64_t new_size = (size > BLOCK_ARENA_CHUNK_SIZE) ? size : BLOCK_ARENA_CHUNK_SIZE;
+
+        this->chunks.push_back(new char[new_size]);
+        this->chunk_size = new_size;
+        this->chunk_used = 0;
+        this->bytes += new_size;
+    }
+
+    void *memory = this->chunks.back() + this->chunk_used;
+    this->chunk_used += size;
+
+    return memory;
+}
+
+//! create(BlockHeader, const char *, uint64_t, string, Hash256, string)
+/*! Parameters: A header as built by Block::make_header and the payload the header commits to.
+Returns a new Block object owned by this arena, with a copy of its data right behind it and its
+tags interned in the pools of this arena.*/
+Block *BlockArena::create(const BlockHeader &header, const char *data, uint64_t data_size,
+                          const std::string &node_address, const Hash256 &blockchain_id,
+                          const std::string &meta_data)
+{
+    char *memory = (char *) this->allocate(sizeof(Block) + data_size);
+    char *payload = memory + sizeof(Block);
+
+    memcpy(payload, data, data_size);
+    this->blocks.reserve(this->blocks.size() + 1);
+
+    Block *block = new (memory) Block(header, payload, data_size, this->pools.node_addresses.intern(node_address),
+                                      this->pools.blockchain_ids.intern(blockchain_id),
+                                      this->pools.meta_tags.intern(meta_data), this);
+    this->blocks.push_back(block);
+
+    return block;
+}
+
+//! copy(Block *)
+/*! Parameters: A Block object owned by anyone.
+Returns a copy of the Block object owned by this arena. The block hash of the copy is computed
+from its header.*/
+Block *BlockArena::copy(Block *block)
+{
+    return this->create(block->get_header(), block->get_data_pointer(), block->get_data_size(),
+                        block->get_node_address(), block->get_blockchain_id(), block->get_meta_data());
+}
+
+//! set_blockchain_id(Block *, Hash256)
+/*! Parameters: A Block object owned by this arena and the ID of the blockchain it belongs to.
+Sets the blockchain ID of the block, interned in the pools of this arena.*/
+void BlockArena::set_blockchain_id(Block *block, const Hash256 &blockchain_id)
+{ block->blockchain_id = this->pools.blockchain_ids.intern(blockchain_id); }
+
+//! set_tags(Block *, string, string)
+/*! Parameters: A Block object owned by this arena, its new node address and its new metadata tag.
+Sets the tags of the block, interned in the pools of this arena, and moves the block within the
+indexes of the ledger storing it.*/
+void BlockArena::set_tags(Block *block, const std::string &node_address, const std::string &meta_data)
+{
+    const std::string *old_node_tag = block->node_address, *old_meta_tag = block->meta_data;
+
+    block->node_address = this->pools.node_addresses.intern(node_address);
+    block->meta_data = this->pools.meta_tags.intern(meta_data);
+
+    if(this->ledger) this->ledger->retag(block, old_node_tag, old_meta_tag);
+}
+
+//! set_data(Block *, const char *, uint64_t)
+/*! Parameters: A Block object owned by this arena and its new data.
+Sets the data of the block to a copy placed in this arena. The memory of the old data is only
+released together with the arena.*/
+void BlockArena::set_data(Block *block, const char *data, uint64_t data_size)
+{
+    char *copy = (char *) this->allocate(data_size);
+    memcpy(copy, data, data_size);
+
+    block->data = copy;
+    block->data_size = data_size;
+}
+
+//! set_ledger(LedgerStore *)
+/*! Parameters: The ledger storing the blocks of this arena, NULL if there is none.*/
+void BlockArena::set_ledger(LedgerStore *ledger)
+{ this->ledger = ledger; }
+
+//! get_block_count(void)
+/*! Returns the number of blocks owned by this arena.*/
+uint64_t BlockArena::get_block_count() const
+{ return this->blocks.size(); }
+
+//! get_memory_usage(void)
+/*! Returns the number of bytes of the chunks allocated by this arena.*/
+uint64_t BlockArena::get_memory_usage() const
+{ return this->bytes; }
+
+//! get_pools(void)
+/*! Returns the pools the tags of the blocks of this arena are interned in.*/
+const TagPools &BlockArena::get_pools() const
+{ return this->pools; }
+
+//! allocated_memory(void)
+/*! Returns the number of bytes allocated on the heap and not freed yet, including the bookkeeping
+of the allocator and large allocations served by mmap, as reported by glibc.
+Returns 0 where it is not available.*/
+static uint64_t allocated_memory()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 info = mallinfo2();
+    return (uint64_t) info.uordblks + (uint64_t) info.hblkhd;
+#elif defined(__GLIBC__)
+    struct mallinfo info = mallinfo();
+    return (uint64_t) (unsigned int) info.uordblks + (uint64_t) (unsigned int) info.hblkhd;
+#else
+    return 0;
+#endif
+}
+
+//! benchmark_block_memory(uint64_t, uint64_t)
+/*! Parameters: The number of blocks to be created and the size of the data of each block in bytes.
+
+Creates the given number of blocks in a BlockArena, as the ledger holds them: every block has its
+own data, a node address out of a handful of miners, a short metadata tag and the same blockchain ID.
+Returns the heap memory taken per block, the size of the payload per block and sizeof(Block),
+all in bytes.*/
+std::map<std::string, double> benchmark_block_memory(uint64_t blocks, uint64_t data_size)
+{
+    std::vector<std::string> miners, tags;
+    for(int i = 0; i < 8; i++) miners.push_back(generate_sha_hash("miner " + std::to_string(i)));
+    for(int i = 0; i < 4; i++) tags.push_back("tag " + std::to_string(i));
+
+    Hash256 blockchain_id = Block("Genesis", miners[0]).get_block_hash();
+    std::string data(data_size, 'x');
+
+    uint64_t before = allocated_memory();
+    BlockArena *arena = new BlockArena();
+
+    for(uint64_t i = 0; i < blocks; i++)
+    {
+        if(data_size) data[0] = (char) ('a' + i % 26);
+        BlockHeader header = Block::make_header(NULL, miners[i % 8], tags[i % 4], data.data(), data.size(), 0, 0, i);
+
+        arena->create(header, data.data(), data.size(), miners[i % 8], blockchain_id, tags[i % 4]);
+    }
+
+    uint64_t after = allocated_memory();
+    delete arena;
+
+    std::map<std::string, double> results;
+    results["bytes_per_block"] = blocks ? (double) (after - before) / blocks : 0;
+    results["payload_bytes_per_block"] = (double) data_size;
+    results["sizeof_block"] = (double) sizeof(Block);
+
+    return results;
+}
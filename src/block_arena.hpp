@@ -0,0 +1,82 @@
+// Copyright 2020 Falk Spickenbaum
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef BLOCK_ARENA_HPP
+#define BLOCK_ARENA_HPP
+
+#include <map>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#ifndef BLOCK_HEADER
+#define BLOCK_HEADER
+#include "block.hpp"
+#endif
+
+// Size of the chunks a BlockArena allocates. Larger blocks get a chunk of their own:
+#define BLOCK_ARENA_CHUNK_SIZE (256 * 1024)
+
+class LedgerStore;
+
+//! BlockArena
+/*! Owns the blocks of a chain. Blocks are bump-allocated out of large chunks, each Block object
+directly followed by its data, so appending a block usually does not call the allocator and the
+blocks of a chain are laid out in the order they were created. The node addresses, metadata tags and
+blockchain IDs of the blocks are interned in the pools of the arena. All blocks and pooled values are
+destroyed together with the arena; a single block cannot be freed. Changes to the payload of a block
+are made through the arena, which passes changed tags on to the ledger storing its blocks.
+
+Not safe to be used from several threads at once.*/
+class BlockArena {
+
+    private:
+
+        std::vector<char *> chunks;
+        std::vector<Block *> blocks;
+        uint64_t chunk_used;
+        uint64_t chunk_size;
+        uint64_t bytes;
+        TagPools pools;
+        LedgerStore *ledger;
+
+        void *allocate(uint64_t size);
+
+        BlockArena(const BlockArena &);
+        BlockArena &operator=(const BlockArena &);
+
+    protected:
+    public:
+
+        BlockArena();
+        ~BlockArena();
+
+        Block *create(const BlockHeader &header, const char *data, uint64_t data_size,
+                      const std::string &node_address, const Hash256 &blockchain_id,
+                      const std::string &meta_data);
+        Block *copy(Block *block);
+        void set_blockchain_id(Block *block, const Hash256 &blockchain_id);
+        void set_tags(Block *block, const std::string &node_address, const std::string &meta_data);
+        void set_data(Block *block, const char *data, uint64_t data_size);
+        void set_ledger(LedgerStore *ledger);
+
+        uint64_t get_block_count() const;
+        uint64_t get_memory_usage() const;
+        const TagPools &get_pools() const;
+};
+
+std::map<std::string, double> benchmark_block_memory(uint64_t blocks, uint64_t data_size);
+
+#endif
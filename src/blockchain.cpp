@@ -27,13 +27,67 @@
 #include "block.cpp"
 #endif
 
+#ifndef BLOCK_ARENA_CPP
+#define BLOCK_ARENA_CPP
+#include "block_arena.cpp"
+#endif
+
+#ifndef HASH_INDEX_CPP
+#define HASH_INDEX_CPP
+#include "hash_index.cpp"
+#endif
+
+#ifndef TAG_INDEX_CPP
+#define TAG_INDEX_CPP
+#include "tag_index.cpp"
+#endif
+
+#ifndef TIME_INDEX_CPP
+#define TIME_INDEX_CPP
+#include "time_index.cpp"
+#endif
+
+#ifndef LEDGER_STORE_CPP
+#define LEDGER_STORE_CPP
+#include "ledger_store.cpp"
+#endif
+
+#ifndef LEDGER_VIEW_CPP
+#define LEDGER_VIEW_CPP
+#include "ledger_view.cpp"
+#endif
+
+#ifndef LEDGER_QUERY_CPP
+#define LEDGER_QUERY_CPP
+#include "ledger_query.cpp"
+#endif
+
+#ifndef MINING_TEMPLATE_CPP
+#define MINING_TEMPLATE_CPP
+#include "mining_template.cpp"
+#endif
+
+#ifndef NONCE_SCHEDULER_CPP
+#define NONCE_SCHEDULER_CPP
+#include "nonce_scheduler.cpp"
+#endif
+
+#ifndef WORKER_POOL_CPP
+#define WORKER_POOL_CPP
+#include "worker_pool.cpp"
+#endif
+
+#ifndef PATTERN_MATCHER_CPP
+#define PATTERN_MATCHER_CPP
+#include "pattern_matcher.cpp"
+#endif
+
+#include <atomic>
 #include <iostream>
 #include <cmath>
 
 using namespace std;
 
-typedef map<string, Block *>::const_iterator iter;
-
 //! Construct a Blockchain object
 /*! Parameters:
 
@@ -51,6 +105,7 @@ Blockchain::Blockchain(long unsigned int try_limit = 100000,
                        float diff_redux_time = 0.5)
 { 
     this->difficulty = 1;
+    this->verified_height = 0;
 
     if(!difficulty_limit || !try_limit)
         throw "diff_threshold and try_limit cannot be zero!";
@@ -61,15 +116,22 @@ Blockchain::Blockchain(long unsigned int try_limit = 100000,
     // Convert hours to milliseconds:
     this->diff_redux_time = (long unsigned int) round(diff_redux_time * 60 * 60 * 1000);
 
-    // Create a Genesis block:
-    static Block genesis = Block(genesis_data, node_addr);
-    genesis.set_blockchain_id(genesis.get_block_hash());
+    // Create a Genesis block, owned by this chain like every other block:
+    this->arena.reset(new BlockArena());
+    this->ledger = LedgerStore(&this->arena->get_pools());
+    this->arena->set_ledger(&this->ledger);
+
+    BlockHeader header = Block::make_header(NULL, node_addr, "GENESIS", genesis_data.data(),
+                                            genesis_data.size(), 0, 0, Block::generate_timestamp());
+    Block *genesis = this->arena->create(header, genesis_data.data(), genesis_data.size(),
+                                         node_addr, Hash256(), "GENESIS");
     
     // Turn the Genesis block hash into the Blockchain ID:
-    this->blockchain_id = genesis.get_block_hash();
+    this->arena->set_blockchain_id(genesis, genesis->get_block_hash());
+    this->blockchain_id = genesis->get_block_hash();
 
     // Try to append Genesis block to ledger:
-    if(!this->append_block(&genesis))
+    if(!this->append_block(genesis))
         cout << "Could not create Genesis block" << endl;
 }
 
@@ -79,37 +141,107 @@ Returns a range of Blocks from the ledger as a vector. If the range exceeds the
 the ledger, an out_of_bounds exception is thrown. Blocks are ordered by ID in ascending order.*/
 vector<Block *> Blockchain::get_blocks_by_range(unsigned int range)
 {
-    vector<Block *> block_range;
-    iter l_iter = this->ledger.begin();
-
     // Check if range exceeds size of ledger:
     if(range > this->ledger.size())
         throw std::out_of_range("Requested range exceeds size of ledger.");
 
-    // Start with the last Block in the ledger:
-    block_range.push_back(this->get_last_block());
-    long unsigned int largest_id = block_range[0]->get_block_id();
+    // The ledger is ordered by block ID, so the last [range] blocks are contiguous:
+    return this->ledger.range(this->ledger.size() - range, range);
+}
 
-    // TODO: Replace this bad, O(n^2) sorting algorithm:
-    while(block_range.size() != range)
-    {
-        if(l_iter == this->ledger.end())
-            l_iter = this->ledger.begin();
+//! get_blocks_by_meta(string, uint64_t, uint64_t, bool)
+/*! Parameters:
 
-        if(l_iter->second->get_block_id() == (largest_id - 1))
-        {
-            block_range.push_back(l_iter->second);
-            largest_id = l_iter->second->get_block_id();
-        }
+meta: A metadata tag.
+offset (optional): The number of matching blocks to be skipped.
+limit (optional): The maximum number of blocks to be returned.
+reverse (optional): If true, the newest blocks come first.
 
-        l_iter++;
-    }
+Returns a page of the blocks carrying the given metadata tag, ordered by block ID. The blocks are
+found through an index of the ledger, so this takes time proportional to the size of the page.*/
+vector<Block *> Blockchain::get_blocks_by_meta(string meta, uint64_t offset = 0,
+                                               uint64_t limit = (uint64_t) -1, bool reverse = false)
+{ return this->ledger.find_by_meta(meta, offset, limit, reverse); }
 
-    // Reverse the vector that was retrieved:
-    reverse(begin(block_range), end(block_range));
+//! count_blocks_by_meta(string)
+/*! Parameters: A metadata tag.
+Returns the number of blocks in the ledger carrying the given metadata tag.*/
+long unsigned int Blockchain::count_blocks_by_meta(string meta)
+{ return (long unsigned int) this->ledger.count_by_meta(meta); }
 
-    return block_range;
-}
+//! get_blocks_by_node(string, uint64_t, uint64_t, bool)
+/*! Parameters:
+
+node_address: The address of a Node object.
+offset (optional): The number of matching blocks to be skipped.
+limit (optional): The maximum number of blocks to be returned.
+reverse (optional): If true, the newest blocks come first.
+
+Returns a page of the blocks mined by the given node, ordered by block ID. The blocks are found
+through an index of the ledger, so this takes time proportional to the size of the page.*/
+vector<Block *> Blockchain::get_blocks_by_node(string node_address, uint64_t offset = 0,
+                                               uint64_t limit = (uint64_t) -1, bool reverse = false)
+{ return this->ledger.find_by_node(node_address, offset, limit, reverse); }
+
+//! count_blocks_by_node(string)
+/*! Parameters: The address of a Node object.
+Returns the number of blocks in the ledger mined by the given node.*/
+long unsigned int Blockchain::count_blocks_by_node(string node_address)
+{ return (long unsigned int) this->ledger.count_by_node(node_address); }
+
+//! get_blocks_by_time(uint64_t, uint64_t, uint64_t, uint64_t, bool)
+/*! Parameters:
+
+start: The earliest UNIX timestamp in milliseconds to be matched.
+end: The UNIX timestamp in milliseconds after the latest one to be matched.
+offset (optional): The number of matching blocks to be skipped.
+limit (optional): The maximum number of blocks to be returned.
+reverse (optional): If true, the newest blocks come first.
+
+Returns a page of the blocks with a timestamp from start up to, but not including, end, ordered by
+block ID. The blocks are found by binary search over the timestamps of the ledger.*/
+vector<Block *> Blockchain::get_blocks_by_time(uint64_t start, uint64_t end, uint64_t offset = 0,
+                                               uint64_t limit = (uint64_t) -1, bool reverse = false)
+{ return this->ledger.find_by_time(start, end, offset, limit, reverse); }
+
+//! count_by_meta(void)
+/*! Returns the number of blocks in the ledger per metadata tag. The counts are kept up to date on
+every append, so this takes time proportional to the number of distinct tags.*/
+map<string, uint64_t> Blockchain::count_by_meta()
+{ return this->ledger.meta_counts(); }
+
+//! count_by_node(void)
+/*! Returns the number of blocks in the ledger per node address. The counts are kept up to date on
+every append, so this takes time proportional to the number of distinct nodes.*/
+map<string, uint64_t> Blockchain::count_by_node()
+{ return this->ledger.node_counts(); }
+
+//! count_by_difficulty(void)
+/*! Returns the number of blocks in the ledger per difficulty, which is kept up to date on every append.*/
+map<uint64_t, uint64_t> Blockchain::count_by_difficulty()
+{ return this->ledger.difficulty_counts(); }
+
+//! histogram_by_time(uint64_t, uint64_t, uint64_t)
+/*! Parameters:
+
+bucket: The width of a bucket in milliseconds.
+start (optional): The earliest UNIX timestamp in milliseconds to be counted.
+end (optional): The UNIX timestamp in milliseconds after the latest one to be counted.
+
+Returns the number of blocks per bucket of time, keyed by the earliest timestamp of the bucket,
+a multiple of its width. Empty buckets are left out. The counts of the last few widths asked for are
+kept up to date as blocks are appended, so only the timestamps of the buckets cut by the ends of the
+time window are read. Throws an invalid_argument exception if the width is 0.*/
+map<uint64_t, uint64_t> Blockchain::histogram_by_time(uint64_t bucket, uint64_t start = 0,
+                                                      uint64_t end = (uint64_t) -1)
+{ return this->ledger.time_histogram(start, end, bucket); }
+
+//! block_time_stats(uint64_t)
+/*! Parameters: The number of newest blocks to be covered (optional), by default all blocks.
+Returns the number of blocks and intervals covered, and the mean, smallest and largest time in
+milliseconds between consecutive blocks. The cost depends on the window, not on the ledger.*/
+BlockTimeStats Blockchain::block_time_stats(uint64_t window = (uint64_t) -1)
+{ return this->ledger.block_time_stats(window); }
 
 //! adjust_difficulty(void)
 /*! Parameters: None
@@ -118,14 +250,14 @@ void Blockchain::adjust_difficulty()
 {
     /* Adjust difficulty once difficulty limit has been reached. */
 
-    auto r_iter = this->ledger.rbegin();
+    if(this->ledger.size() < 2) return;
 
-    // Get the UNIX timestamp stored in the last block and the second to last block:
-    long unsigned int time1 = stoi(r_iter->second->get_timestamp());
-    long unsigned int time2 = stoi((++r_iter)->second->get_timestamp());
+    // Get the UNIX timestamp in milliseconds stored in the last block and the second to last block:
+    uint64_t time1 = this->ledger.tip()->get_timestamp();
+    uint64_t time2 = this->ledger.at(this->ledger.size() - 2)->get_timestamp();
 
-    // If time difference is greater than redux time, half difficulty:
-    if((time1 - time2) >= this->diff_redux_time || this->difficulty > 255)
+    // If time difference is greater than redux time, half difficulty. A clock running behind does not count:
+    if((time1 > time2 && time1 - time2 >= this->diff_redux_time) || this->difficulty > 255)
     {
         this->difficulty = (unsigned int) round(this->difficulty / 2);
         return;
@@ -138,27 +270,48 @@ void Blockchain::adjust_difficulty()
 
 //! verify_block(Block *)
 /*! Parameters: Any block object to be validated. 
-Tries to verify a given block against the whole blockchain.
+Tries to verify a given block against the whole blockchain. Only the block headers are inspected:
+every block has to link to a block one height below it, down to the Genesis block of this chain.
+The walk stops at the first ancestor below the verified height, so verifying a block on top of
+a verified ledger takes a single lookup.
 Returns true on success, false on failure.*/
 bool Blockchain::verify_block(Block *block)
 {
     /* Verify a given block against the entire ledger. */
 
-    // Return false if block was not mined on this chain:
-    if(block->get_blockchain_id() != this->blockchain_id) 
-        return false;
+    while(block->get_block_id() != 0)
+    {
+        Block *found_block = this->ledger.find(block->get_prev_hash());
 
-    // Return true if block is Genesis:
-    if(block->get_block_id() == 0) return true;
+        // Return false if the previous block is unknown or not directly below this block:
+        if(!found_block || found_block->get_block_id() + 1 != block->get_block_id())
+            return false;
 
-    iter found_block = this->ledger.find(block->get_prev_hash());
-    bool is_found = found_block != this->ledger.end();
+        // The ledger below the verified height links down to the Genesis block already:
+        if(found_block->get_block_id() < this->verified_height)
+            return true;
 
-    // If ledger contains the previous hash, recurse:
-    if(is_found) return this->verify_block(this->ledger.at(block->get_prev_hash()));
+        block = found_block;
+    }
 
-    //Else, return false
-    return false;
+    // Return true if block is the Genesis block of this chain:
+    return block->get_block_hash() == this->blockchain_id;
+}
+
+//! verify_chain(void)
+/*! Parameters: None
+Verifies the whole ledger from scratch, ignoring the verified height, by walking down from the
+last block to the Genesis block. Returns true on success, false on failure, in which case no
+block counts as verified until the ledger verifies again.*/
+bool Blockchain::verify_chain()
+{
+    this->verified_height = 0;
+
+    if(!this->ledger.size() || !this->verify_block(this->ledger.tip()))
+        return false;
+
+    this->verified_height = this->ledger.size();
+    return true;
 }
 
 //! mine_block(string, string)
@@ -175,21 +328,21 @@ Block *Blockchain::mine_block(string data, string node_address, string meta_data
 {
     /* Mine a new block by solving a proof-of-work puzzle. */
 
-    int nonce = 0;
-    Block *try_block = NULL;
-    unsigned long tries = 0;
+    Block *prev = this->get_last_block();
 
-    do
-    {
-        // Check if try limit has been exceeded
-        if(tries++ == this->try_limit) return NULL;
+    // Hash the constant part of the header once, only the nonce varies:
+    MiningTemplate tmpl(prev, data, node_address, meta_data, this->get_difficulty(), this->blockchain_id);
+    NonceScheduler scheduler(0, this->try_limit, 1);
+    MiningToken token;
+
+    this->mine_nonce_chunks(tmpl, scheduler, token, 0);
 
-        // Create a block with the next nonce
-        try_block = new Block(this->get_last_block(), data, node_address,
-                            nonce++, this->get_difficulty(), this->blockchain_id,
-                            meta_data);
+    this->coverage = scheduler.get_coverage();
 
-    } while(!verify_attempt(try_block));
+    uint64_t nonce;
+    if(!token.get_winner(nonce)) return NULL;
+
+    Block *try_block = tmpl.materialize(nonce, *this->arena);
 
     // Try and append/verify the new block on the blockchain
     if(!this->append_block(try_block))
@@ -201,6 +354,46 @@ Block *Blockchain::mine_block(string data, string node_address, string meta_data
     return try_block;
 }
 
+//! mine_nonce_chunks(MiningTemplate, NonceScheduler &, MiningToken &, unsigned int)
+/*! Parameters:
+
+tmpl: The template of the block to be mined.
+scheduler: The scheduler handing out the nonces of this attempt.
+token: The token shared by all workers of this attempt.
+worker: The index of the calling worker.
+
+The loop run by every mining worker: takes chunks of nonces from the scheduler and hashes them in
+batches of one nonce per SIMD lane, until a nonce satisfies the difficulty, the token has been
+cancelled or no chunks are left. A winning nonce is submitted to the token. Workers never touch
+the ledger or the arena, so they may run while these are being modified.*/
+void Blockchain::mine_nonce_chunks(const MiningTemplate &tmpl, NonceScheduler &scheduler,
+                                   MiningToken &token, unsigned int worker)
+{
+    unsigned int lanes = tmpl.get_lanes();
+    uint64_t first, last;
+
+    // Each worker only writes the nonce bytes of its own buffer:
+    Sha256NonceBuffer buffer;
+    tmpl.prepare(buffer);
+
+    while(!token.is_cancelled() && scheduler.next_chunk(first, last))
+    {
+        uint64_t nonce = first;
+
+        while(nonce < last && !token.is_cancelled())
+        {
+            unsigned int count = (unsigned int) min((uint64_t) lanes, last - nonce);
+            uint64_t found;
+
+            // A nonce found at the same time as the winner is dropped:
+            if(tmpl.try_nonces(buffer, nonce, count, found)) token.submit(found);
+            nonce += count;
+        }
+
+        scheduler.record(worker, first, nonce);
+    }
+}
+
 //! adjust_block_id_and_append(Block *)
 /*! Parameters: Some Block object.
 An internal method that ensures that a block's ID does not clash with any ID already stored in the ledger.*/
@@ -216,13 +409,12 @@ void Blockchain::adjust_block_id_and_append(Block *block)
 
 //! append_block(Block *)
 /*! Parameters: Some Block object to be append to the ledger.
-Tries to append a Block object into the ledger.
-Returns true on success and false on failure, i.e. if the Block could not be verified.*/
+Tries to append a Block object on top of the last block in the ledger.
+Returns true on success and false on failure, i.e. if the Block could not be verified
+or does not extend the last block.*/
 bool Blockchain::append_block(Block *block)
 {
     /* Append a block to the ledger. */
-    string block_hash = block->get_block_hash();
-    std::pair<std::string, Block *> nextBlock (block_hash, block);
 
     try 
     { 
@@ -233,8 +425,14 @@ bool Blockchain::append_block(Block *block)
             return false;
         }
 
-        // Try to insert the block-string pair into the ledger:
-        Blockchain::ledger.insert(nextBlock); 
+        // Try to store the block on top of the last block:
+        if(block->get_block_id() && block->get_prev_hash() != this->ledger.tip()->get_block_hash())
+            return false;
+
+        if(!this->ledger.append(block)) return false;
+
+        // Every block below the new one has been walked, or was verified before:
+        this->verified_height = this->ledger.size();
         return true; 
     }
     catch(exception &ex)
@@ -242,23 +440,20 @@ bool Blockchain::append_block(Block *block)
 }
 
 //! get_block(string)
-/*! Parameters: A block hash as a string.
+/*! Parameters: A block hash.
 Find a Block object in the ledger by hash.
 Returns a Block object on success, NULL on failure.*/
-Block *Blockchain::get_block(string hash)
+Block *Blockchain::get_block(Hash256 hash)
 {
-    // Get an iterator to the hash in question:
-    iter find = this->ledger.find(hash);
+    // Look up the hash in question:
+    Block *find = this->ledger.find(hash);
 
     // If ledger does not contain the hash, return NULL
-    if(find == this->ledger.end())
-    {
-       cout << "Could not retrieve block with hash " << hash << endl;
-       return NULL;
-    }
+    if(!find)
+       cout << "Could not retrieve block with hash " << hash.to_hex() << endl;
 
     // Return the Block in question:
-    return this->ledger.at(hash);
+    return find;
 }
 
 //! get_block_by_index(unsigned int)
@@ -268,126 +463,189 @@ Get the Block object at the specified index in the ledger.*/
 Block *Blockchain::get_block_by_index(unsigned int index)
 {
     // Throw out of range exception if index is too large:
-    if(index > this->get_ledger_size())
+    if(index >= this->get_ledger_size())
         throw out_of_range("Requested index exceeds size of ledger.");
 
-    // Get all blocks from ledger:
-    vector<Block *> blocks = this->get_blocks_by_range(this->get_ledger_size());
-    // Return block at [index]
-    return blocks[index];
+    // Return block at [index], which has the block ID [index]:
+    return this->ledger.at(index);
 }
 
+//! check_thread_avail(unsigned int)
+/*! Parameters: The number of threads requested.
+Returns the number of mining threads to be used: at least one, and no more than the number of
+hardware threads, as further threads would only share the same cores.*/
 unsigned int check_thread_avail(unsigned int threads)
 {
-    unsigned int adj_threads = threads - (threads - thread::hardware_concurrency()) - 1;
-    return (threads < thread::hardware_concurrency()) ? threads : adj_threads;
-}
+    unsigned int cores = thread::hardware_concurrency();
 
-//! mine_block_concurrently(string, string, string, unsigned int)
-/*! Parameters:
+    if(!threads) return 1;
 
-data: The data to be stored in the new block, as a string.
-node_address: A string identifier of a blockchain user. 
-meta_data: Metadata to be stored in the block.
-threads: The number of threads to be used.     
-If only fewer threads are available, the maximum - 1 will be used. 
+    // hardware_concurrency returns 0 if the number is unknown:
+    return (cores && threads > cores) ? cores : threads;
+}
 
-This method tries to mine a single block in various threads. 
-If an attempt should be started on a single thread, use mine_block(string, string).*/
-Block *Blockchain::mine_block_concurrently(string data, string node_address,                                             
-                                           string meta_data = "", unsigned int threads = 5)
+//! validate_block(Block *, Block *, Hash256)
+/*! Parameters: A Block object, the Block object below it (NULL for Genesis) and the blockchain ID.
+Returns true if the block hash and payload digest of the block are correct, its hash satisfies its
+difficulty and it links to the block below it, else returns false.*/
+static bool validate_block(Block *block, Block *prev, const Hash256 &blockchain_id)
 {
-    vector<future<Block *>> futs;
-    unsigned int prev_id = this->get_last_block()->get_block_id();
+    if(!block->verify_hashes() || !run_hash_cash(block)) return false;
+    if(block->get_blockchain_id() != blockchain_id) return false;
 
-    // Check if enough threads are available to satisfy user request,
-    // else adjust to one thread below maximum
-    threads = check_thread_avail(threads);
+    // The Genesis block is the block whose hash is the blockchain ID:
+    if(!prev) return block->get_block_id() == 0 && block->get_block_hash() == blockchain_id;
 
-    for(unsigned int i = 0; i < threads; i++)
-    {
-        // Create a future containing a modified version of the 
-        // mining algorithm:
-        futs.push_back(async([this, data, node_address, meta_data, prev_id]{
+    return block->get_block_id() == prev->get_block_id() + 1 &&
+           block->get_prev_hash() == prev->get_block_hash();
+}
 
-            int nonce = 0;
-            Block *try_block = NULL;
-            unsigned long tries = 0;
+//! validate_chain(unsigned int)
+/*! Parameters: The number of threads to be used, 0 for one per hardware thread.
 
-            do
-            {   
-                // Check if block has already been mined by another worker:
-                if(this->get_last_block()->get_block_id() == prev_id + 1)
-                    return (Block *) NULL;
+Validates every block in the ledger from scratch: recomputes its payload digest and block hash,
+checks its proof-of-work, its block ID, its blockchain ID and its link to the block below it.
+The ledger is split into segments of VALIDATION_SEGMENT_SIZE blocks which the threads take in
+ascending order; segments above an invalid block are skipped.
+Returns the block ID of the first invalid block, -1 if the whole ledger is valid.*/
+long int Blockchain::validate_chain(unsigned int threads = 0)
+{
+    uint64_t size = this->ledger.size();
+    uint64_t segments = (size + VALIDATION_SEGMENT_SIZE - 1) / VALIDATION_SEGMENT_SIZE;
 
-                // Check if try limit has been exceeded
-                if(tries++ == this->try_limit) return (Block *) NULL;
+    threads = threads ? check_thread_avail(threads) : check_thread_avail(thread::hardware_concurrency());
+    if(threads > segments) threads = (unsigned int) max((uint64_t) 1, segments);
 
-                // Create a block with the next nonce
-                try_block = new Block(this->get_last_block(), data, node_address,
-                                    nonce++, this->get_difficulty(), this->blockchain_id,
-                                    meta_data);
+    std::atomic<uint64_t> next_segment(0);
+    std::atomic<uint64_t> first_invalid(size);
 
-            } while(!verify_attempt(try_block));
+    worker_pool().run(threads, [this, size, segments, &next_segment, &first_invalid](unsigned int){
+        for(uint64_t s = next_segment++; s < segments; s = next_segment++)
+        {
+            uint64_t first = s * VALIDATION_SEGMENT_SIZE;
+            uint64_t last = min(first + VALIDATION_SEGMENT_SIZE, size);
 
-            return try_block;
+            for(uint64_t i = first; i < last && i < first_invalid.load(); i++)
+            {
+                if(validate_block(this->ledger.at(i), i ? this->ledger.at(i - 1) : NULL, this->blockchain_id))
+                    continue;
 
-        }));
-    }
+                // Keep the lowest invalid block ID found by any thread:
+                uint64_t current = first_invalid.load();
+                while(i < current && !first_invalid.compare_exchange_weak(current, i));
+                break;
+            }
+        }
+    });
 
-    // Return the value that is retrieved from the futures:
-    return this->retrieve_data_from_futures(&futs, threads);
+    // The blocks below the first invalid one link down to the Genesis block:
+    this->verified_height = first_invalid.load();
 
+    return (first_invalid.load() == size) ? -1 : (long int) first_invalid.load();
 }
 
-Block *Blockchain::retrieve_data_from_futures(vector<future<Block *>> *futs, unsigned int threads)
+//! search_data(string, uint64_t, unsigned int, bool)
+/*! Parameters:
+
+pattern: The bytes to be found in the data of the blocks.
+limit (optional): The maximum number of blocks to be found.
+threads (optional): The number of threads to be used, 0 for one per hardware thread.
+reverse (optional): If true, the search starts at the newest block.
+
+Searches the data of every block in the ledger for the pattern. The ledger is split into segments
+of SEARCH_SEGMENT_SIZE blocks which the threads take in order. Once the segments searched so far
+hold limit matches, no further segments are taken; since they are taken in order, the matches
+found are the first ones.
+Returns the block IDs of the matching blocks, in ascending order unless reversed.*/
+vector<uint64_t> Blockchain::search_data(string pattern, uint64_t limit = (uint64_t) -1, unsigned int threads = 0,
+                                         bool reverse = false)
 {
-    Block *next_block = NULL;
+    uint64_t size = this->ledger.size();
+    uint64_t segments = (size + SEARCH_SEGMENT_SIZE - 1) / SEARCH_SEGMENT_SIZE;
 
-    // Loop while not all threads have returned:
-    do
-    {
-        // Check each future once:
-        for(unsigned int i = 0; i < (*futs).size(); i++)
-        {
-            // Skip invalid futures (i.e. all futures that have already returned:)
-            if(!(*futs)[i].valid()) continue;
+    threads = threads ? check_thread_avail(threads) : check_thread_avail(thread::hardware_concurrency());
+    if(threads > segments) threads = (unsigned int) max((uint64_t) 1, segments);
 
-            // Check if current future is ready:
-            if((*futs)[i].wait_for(chrono::milliseconds(10)) != future_status::ready)
-                continue;
+    PatternMatcher matcher(pattern);
+    vector<vector<uint64_t>> hits(segments);
+    std::atomic<uint64_t> next_segment(0);
+    std::atomic<uint64_t> found(0);
 
-            // Modify thread count:
-            threads -= 1;
+    worker_pool().run(threads, [this, size, segments, limit, reverse, &matcher, &hits, &next_segment, &found]
+                               (unsigned int){
+        for(uint64_t s = next_segment++; s < segments && found.load() < limit; s = next_segment++)
+        {
+            uint64_t first = s * SEARCH_SEGMENT_SIZE;
+            uint64_t count = min((uint64_t) SEARCH_SEGMENT_SIZE, size - first);
 
-            // Check if result is NULL. If it isn't, return the block that was mined:
-            if((next_block = (*futs)[i].get()) != NULL) 
+            for(uint64_t i = 0; i < count && hits[s].size() < limit; i++)
             {
-                // Try and append/verify the new block on the blockchain
-                if(!this->append_block(next_block))
-                    cout << "Could not append block to chain." << endl;
-
-                // Adjust difficulty after new block has been mined:
-                this->adjust_difficulty();
-                return (Block *) next_block;
+                Block *block = this->ledger.at(reverse ? size - 1 - first - i : first + i);
+                if(matcher.match(block->get_data_pointer(), block->get_data_size()))
+                    hits[s].push_back(block->get_block_id());
             }
+
+            found += hits[s].size();
         }
+    });
 
-    } while(threads != 0);
+    vector<uint64_t> heights;
 
-    // If no block could be mined, return NULL:
-    return NULL;
+    for(uint64_t s = 0; s < segments && heights.size() < limit; s++)
+        heights.insert(heights.end(), hits[s].begin(),
+                       hits[s].begin() + min((uint64_t) hits[s].size(), limit - heights.size()));
+
+    return heights;
 }
 
-long unsigned int count_pow(Ledger l)
+//! mine_block_concurrently(string, string, string, unsigned int)
+/*! Parameters:
+
+data: The data to be stored in the new block, as a string.
+node_address: A string identifier of a blockchain user. 
+meta_data: Metadata to be stored in the block.
+threads: The number of threads to be used.     
+If only fewer hardware threads are available, one thread per hardware thread will be used.
+
+This method tries to mine a single block in various threads. The nonces of the attempt are
+split into chunks, and each chunk is hashed by exactly one thread. The threads are taken from
+the shared worker pool, which stays alive between blocks.
+If an attempt should be started on a single thread, use mine_block(string, string).*/
+Block *Blockchain::mine_block_concurrently(string data, string node_address,                                             
+                                           string meta_data = "", unsigned int threads = 5)
 {
-    long unsigned int cml_pow = 0;
-    iter i = l.begin();
+    Block *prev = this->get_last_block();
+
+    // Check if enough threads are available to satisfy user request,
+    // else adjust to the number of hardware threads
+    threads = check_thread_avail(threads);
+
+    // All workers share one template and scheduler:
+    MiningTemplate tmpl(prev, data, node_address, meta_data, this->get_difficulty(), this->blockchain_id);
+    NonceScheduler scheduler(0, this->try_limit, threads);
+    MiningToken token;
+
+    // Run one mining worker per thread. The pool wakes this thread up as soon as the last
+    // worker has returned, which is right after the winner has cancelled the token:
+    worker_pool().run(threads, [this, &tmpl, &scheduler, &token](unsigned int i){
+        this->mine_nonce_chunks(tmpl, scheduler, token, i);
+    });
 
-    do cml_pow += (long unsigned int) pow(2, i->second->get_difficulty());
-    while(++i != l.end());
+    this->coverage = scheduler.get_coverage();
 
-    return cml_pow;
+    uint64_t nonce;
+    if(!token.get_winner(nonce)) return NULL;
+
+    Block *next_block = tmpl.materialize(nonce, *this->arena);
+
+    // Try and append/verify the new block on the blockchain
+    if(!this->append_block(next_block))
+        cout << "Could not append block to chain." << endl;
+
+    // Adjust difficulty after new block has been mined:
+    this->adjust_difficulty();
+
+    return next_block;
 }
 
 //! find_consensus(Blockchain *)
@@ -395,13 +653,34 @@ long unsigned int count_pow(Ledger l)
 This method attempts to find a consensus between to ledgers by comparing the cumulative 
 proof-of-work contained in the ledger.
 If the foreign blockchain contains more cumulative proof-of-work, the ledger of this Blockchain object 
-is replaced. If this is the case, this case returns true. Else it returns false.*/
+is replaced by a copy of the foreign ledger, and this Blockchain object takes on the ID of the foreign
+blockchain. Block objects of the replaced ledger are kept until this Blockchain object is destroyed.
+If this is the case, this case returns true. Else it returns false.*/
 bool Blockchain::find_consensus(Blockchain *foreign_chain)
 {
     // Compare the cumulative proof-of-work contained within the ledger:
-    if(count_pow(foreign_chain->get_ledger()) > count_pow(this->ledger))
+    if(foreign_chain->ledger.get_work() > this->ledger.get_work())
     {
-        this->ledger = foreign_chain->get_ledger();
+        // Copy the foreign blocks into an arena of this chain, so both chains stay independent:
+        unique_ptr<BlockArena> arena(new BlockArena());
+        LedgerStore ledger(&arena->get_pools());
+
+        for(uint64_t i = 0; i < foreign_chain->ledger.size(); i++)
+            if(!ledger.append(arena->copy(foreign_chain->ledger.at(i)))) return false;
+
+        // Blocks of the replaced ledger may still be referenced, so the old arena lives on with the chain:
+        this->arena.swap(arena);
+
+        // Only the blocks of the new arena are stored in the ledger, so only their tag changes move index entries:
+        this->arena->set_ledger(&this->ledger);
+        arena->set_ledger(NULL);
+        this->retired_arenas.push_back(std::move(arena));
+        this->ledger = ledger;
+        this->blockchain_id = foreign_chain->blockchain_id;
+
+        // The foreign ledger has been verified against the foreign chain only,
+        // so the next block appended walks it down to the Genesis block again:
+        this->verified_height = 0;
         return true;
     }
 
@@ -427,9 +706,13 @@ void Blockchain::set_redux_time(float time)
     this->diff_redux_time = (long unsigned int) time; 
 }
 
-//! Return the ledger contained in the Blockchain object
-Ledger Blockchain::get_ledger()
-{ return this->ledger; }
+//! Return a read-only view of the ledger, which borrows its storage instead of copying it
+LedgerView Blockchain::get_ledger_view()
+{ return LedgerView(&this->ledger); }
+
+//! Return a query over the ledger without any filters, to be narrowed down and read through a LedgerCursor
+LedgerQuery Blockchain::query()
+{ return LedgerQuery(&this->ledger); }
 
 //! Get the current difficulty contained within the Blockchain object
 long unsigned int Blockchain::get_difficulty()
@@ -439,22 +722,13 @@ long unsigned int Blockchain::get_difficulty()
 long unsigned int Blockchain::get_ledger_size()
 { return (long unsigned int) this->ledger.size(); }
 
+//! Get the cumulative proof-of-work of the ledger, i.e. the sum of 2^difficulty over all blocks
+ChainWork Blockchain::get_cumulative_work()
+{ return this->ledger.get_work(); }
+
 //! Get the last block in the ledger, meaning the block with the highest block ID
 Block *Blockchain::get_last_block()
-{ 
-    iter r = this->ledger.begin();
-    Block *last_block = r->second;
-
-    // Find the block with the highest block ID:
-    while(++r != this->ledger.end())
-    {
-        if(r->second->get_block_id() > last_block->get_block_id())
-            last_block = r->second;
-        
-    }
-
-    return last_block; 
-}
+{ return this->ledger.tip(); }
 
 //! Get the current number of Blocks at which the difficulty is raised
 unsigned int Blockchain::get_difficulty_limit()
@@ -469,5 +743,10 @@ long unsigned int Blockchain::get_redux_time()
 { return this->diff_redux_time; }
 
 //! Get the identifier of the Blockchain object:
-string Blockchain::get_blockchain_id()
-{ return this->blockchain_id; }
\ No newline at end of file
+Hash256 Blockchain::get_blockchain_id()
+{ return this->blockchain_id; }
+
+//! get_mining_coverage(void)
+/*! Returns the nonces each worker has hashed during the last mining attempt on this Blockchain.*/
+vector<WorkerCoverage> Blockchain::get_mining_coverage()
+{ return this->coverage; }
\ No newline at end of file
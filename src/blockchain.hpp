@@ -23,12 +23,57 @@
 #include "block.hpp"
 #endif
 
+#ifndef BLOCK_ARENA_HEADER
+#define BLOCK_ARENA_HEADER
+#include "block_arena.hpp"
+#endif
+
+#ifndef LEDGER_STORE_HEADER
+#define LEDGER_STORE_HEADER
+#include "ledger_store.hpp"
+#endif
+
+#ifndef LEDGER_VIEW_HEADER
+#define LEDGER_VIEW_HEADER
+#include "ledger_view.hpp"
+#endif
+
+#ifndef LEDGER_QUERY_HEADER
+#define LEDGER_QUERY_HEADER
+#include "ledger_query.hpp"
+#endif
+
+#ifndef MINING_TEMPLATE_HEADER
+#define MINING_TEMPLATE_HEADER
+#include "mining_template.hpp"
+#endif
+
+#ifndef NONCE_SCHEDULER_HEADER
+#define NONCE_SCHEDULER_HEADER
+#include "nonce_scheduler.hpp"
+#endif
+
+#ifndef PATTERN_MATCHER_HEADER
+#define PATTERN_MATCHER_HEADER
+#include "pattern_matcher.hpp"
+#endif
+
+#ifndef WORKER_POOL_HEADER
+#define WORKER_POOL_HEADER
+#include "worker_pool.hpp"
+#endif
+
 #include <stdint.h>
 #include <ctime>
+#include <memory>
 #include <vector>
 
-typedef std::map<std::string, Block *> Ledger;
-#include <future>
+
+// Number of blocks validate_chain hands to a thread at once:
+#define VALIDATION_SEGMENT_SIZE 4096
+
+// Number of blocks search_data hands to a thread at once:
+#define SEARCH_SEGMENT_SIZE 4096
 
 //! Blockchain
 /*! This class implements a Blockchain structure and various methods
@@ -38,8 +83,18 @@ class Blockchain {
 
     private:
 
-        Ledger ledger;
-        std::string blockchain_id;
+        // The arena owns every block of the ledger:
+        std::unique_ptr<BlockArena> arena;
+        // Arenas of ledgers replaced by find_consensus, whose blocks may still be referenced from Python:
+        std::vector<std::unique_ptr<BlockArena>> retired_arenas;
+        LedgerStore ledger;
+        Hash256 blockchain_id;
+
+        // The blocks below this height have been verified down to the Genesis block:
+        uint64_t verified_height;
+
+        // How the nonces of the last mining attempt were shared by the threads:
+        std::vector<WorkerCoverage> coverage;
 
         unsigned int difficulty;
         long unsigned int try_limit;
@@ -49,8 +104,9 @@ class Blockchain {
         bool append_block(Block *block);
         void adjust_block_id_and_append(Block *block);
         void adjust_difficulty();
+        void mine_nonce_chunks(const MiningTemplate &tmpl, NonceScheduler &scheduler,
+                               MiningToken &token, unsigned int worker);
 
-        Block *retrieve_data_from_futures(std::vector<std::future<Block *>> *futs, unsigned int threads);
     protected:
     public:
 
@@ -60,23 +116,42 @@ class Blockchain {
                     std::string genesis_data, float diff_redux_time);
 
         bool verify_block(Block *block);
+        bool verify_chain();
+        long int validate_chain(unsigned int threads);
+        std::vector<uint64_t> search_data(std::string pattern, uint64_t limit, unsigned int threads, bool reverse);
         Block *mine_block(std::string data, std::string node_address, std::string data_description);
         Block *mine_block_concurrently(std::string data, std::string node_address, 
                                        std::string meta_data, unsigned int threads);
 
         bool find_consensus(Blockchain *foreign_chain);
         std::vector<Block *> get_blocks_by_range(unsigned int range);
+        std::vector<Block *> get_blocks_by_meta(std::string meta, uint64_t offset, uint64_t limit, bool reverse);
+        long unsigned int count_blocks_by_meta(std::string meta);
+        std::vector<Block *> get_blocks_by_node(std::string node_address, uint64_t offset, uint64_t limit,
+                                                bool reverse);
+        long unsigned int count_blocks_by_node(std::string node_address);
+        std::vector<Block *> get_blocks_by_time(uint64_t start, uint64_t end, uint64_t offset, uint64_t limit,
+                                                bool reverse);
+
+        std::map<std::string, uint64_t> count_by_meta();
+        std::map<std::string, uint64_t> count_by_node();
+        std::map<uint64_t, uint64_t> count_by_difficulty();
+        std::map<uint64_t, uint64_t> histogram_by_time(uint64_t bucket, uint64_t start, uint64_t end);
+        BlockTimeStats block_time_stats(uint64_t window);
         Block *get_block_by_index(unsigned int index);
 
         Block *get_last_block();
-        Ledger get_ledger();
-        Block *get_block(std::string hash);
+        LedgerView get_ledger_view();
+        LedgerQuery query();
+        Block *get_block(Hash256 hash);
         unsigned int get_difficulty_limit();
         long unsigned int get_try_limit();
         long unsigned int get_difficulty();
         long unsigned int get_ledger_size();
+        ChainWork get_cumulative_work();
         long unsigned int get_redux_time();
-        std::string get_blockchain_id();
+        Hash256 get_blockchain_id();
+        std::vector<WorkerCoverage> get_mining_coverage();
 
         void set_difficulty_limit(unsigned int difficulty_limit);
         void set_try_limit(long unsigned int try_limit);
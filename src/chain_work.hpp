@@ -0,0 +1,93 @@
+// Copyright 2020 Falk Spickenbaum
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef CHAIN_WORK_HPP
+#define CHAIN_WORK_HPP
+
+#include <stdint.h>
+#include <stdexcept>
+#include <string>
+
+// Number of 64 bit words of a ChainWork. 320 bits hold 2^64 blocks of difficulty 256:
+#define CHAIN_WORK_WORDS 5
+
+//! ChainWork
+/*! The cumulative proof-of-work of a chain as an exact unsigned integer. A block of difficulty d
+adds 2^d, the expected number of hashes needed to mine it. Since a block hash has 256 bits, no
+valid block has a difficulty above 256.*/
+struct ChainWork {
+
+    // Least significant word first:
+    uint64_t words[CHAIN_WORK_WORDS];
+
+    //! Construct a zero amount of work
+    ChainWork()
+    { for(int i = 0; i < CHAIN_WORK_WORDS; i++) this->words[i] = 0; }
+
+    //! add_block(long unsigned int)
+    /*! Parameters: The difficulty of a block.
+    Adds 2^difficulty. Throws an overflow_error exception if the sum exceeds 320 bits.*/
+    void add_block(long unsigned int difficulty)
+    {
+        if(difficulty >= 64 * CHAIN_WORK_WORDS)
+            throw std::overflow_error("Block difficulty exceeds the range of the cumulative work.");
+
+        uint64_t carry = (uint64_t) 1 << (difficulty % 64);
+
+        for(int i = difficulty / 64; carry && i < CHAIN_WORK_WORDS; i++)
+        {
+            this->words[i] += carry;
+            carry = (this->words[i] < carry) ? 1 : 0;
+        }
+
+        if(carry) throw std::overflow_error("Cumulative work exceeds 320 bits.");
+    }
+
+    //! to_hex(void)
+    /*! Returns the work in lower-case hexadecimal notation, without leading zeros.*/
+    std::string to_hex() const
+    {
+        static const char digits[] = "0123456789abcdef";
+        std::string hex;
+
+        for(int i = CHAIN_WORK_WORDS - 1; i >= 0; i--)
+            for(int shift = 60; shift >= 0; shift -= 4)
+            {
+                int digit = (this->words[i] >> shift) & 0xf;
+                if(digit || !hex.empty()) hex += digits[digit];
+            }
+
+        return hex.empty() ? "0" : hex;
+    }
+
+    bool operator==(const ChainWork &other) const
+    {
+        for(int i = 0; i < CHAIN_WORK_WORDS; i++)
+            if(this->words[i] != other.words[i]) return false;
+        return true;
+    }
+
+    bool operator<(const ChainWork &other) const
+    {
+        for(int i = CHAIN_WORK_WORDS - 1; i >= 0; i--)
+            if(this->words[i] != other.words[i]) return this->words[i] < other.words[i];
+        return false;
+    }
+
+    bool operator>(const ChainWork &other) const
+    { return other < *this; }
+};
+
+#endif
@@ -0,0 +1,124 @@
+// Copyright 2020 Falk Spickenbaum
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HASH256_HPP
+#define HASH256_HPP
+
+#include <stdint.h>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+//! Hash256
+/*! A raw 32 byte SHA256 digest. Block hashes, previous hashes and blockchain IDs are stored and
+compared in this form. Hexadecimal notation is only produced when a hash is handed to Python.
+Hashes order the same way as their hexadecimal notation does.*/
+struct Hash256 {
+
+    unsigned char bytes[32];
+
+    //! Construct an all-zero hash
+    Hash256() { memset(this->bytes, 0, sizeof(this->bytes)); }
+
+    //! from_hex(string)
+    /*! Parameters: A hash in hexadecimal notation, as 64 characters.
+    Returns the raw hash. Throws an invalid_argument exception if the string is not a valid hash.*/
+    static Hash256 from_hex(const std::string &hex)
+    {
+        Hash256 hash;
+
+        if(hex.size() != 64)
+            throw std::invalid_argument("A hash must consist of 64 hexadecimal characters.");
+
+        for(int i = 0; i < 32; i++)
+        {
+            int high = hex_value(hex[2 * i]), low = hex_value(hex[2 * i + 1]);
+
+            if(high < 0 || low < 0)
+                throw std::invalid_argument("Invalid hexadecimal character in hash " + hex);
+
+            hash.bytes[i] = (unsigned char) (high << 4 | low);
+        }
+
+        return hash;
+    }
+
+    //! to_hex(void)
+    /*! Returns the hash in lower-case hexadecimal notation.*/
+    std::string to_hex() const
+    {
+        static const char digits[] = "0123456789abcdef";
+        std::string hex(64, '0');
+
+        for(int i = 0; i < 32; i++)
+        {
+            hex[2 * i] = digits[this->bytes[i] >> 4];
+            hex[2 * i + 1] = digits[this->bytes[i] & 0xf];
+        }
+
+        return hex;
+    }
+
+    //! word(int)
+    /*! Returns the i-th 64 bit word of the hash in big-endian order, i.e. word(0) holds the first 8 bytes.*/
+    uint64_t word(int i) const
+    {
+        uint64_t w = 0;
+        for(int b = 0; b < 8; b++) w = (w << 8) | this->bytes[8 * i + b];
+        return w;
+    }
+
+    bool is_zero() const
+    { return *this == Hash256(); }
+
+    bool operator==(const Hash256 &other) const
+    { return memcmp(this->bytes, other.bytes, sizeof(this->bytes)) == 0; }
+
+    bool operator!=(const Hash256 &other) const
+    { return !(*this == other); }
+
+    bool operator<(const Hash256 &other) const
+    { return memcmp(this->bytes, other.bytes, sizeof(this->bytes)) < 0; }
+
+    private:
+
+        static int hex_value(char c)
+        {
+            if(c >= '0' && c <= '9') return c - '0';
+            if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+            if(c >= 'A' && c <= 'F') return c - 'A' + 10;
+            return -1;
+        }
+};
+
+static_assert(sizeof(Hash256) == 32, "Hash256 must not contain padding.");
+static_assert(std::is_trivially_copyable<Hash256>::value, "Hash256 must be trivially copyable.");
+
+namespace std {
+
+    //! The last 8 bytes of a SHA256 hash make a good hash. Block hashes start with the zero bits
+    //! required by the difficulty, so their first bytes do not.
+    template <> struct hash<Hash256> {
+        size_t operator()(const Hash256 &h) const
+        {
+            uint64_t w;
+            memcpy(&w, h.bytes + 24, sizeof(w));
+            return (size_t) w;
+        }
+    };
+}
+
+#endif
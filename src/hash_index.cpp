@@ -0,0 +1,325 @@
+// Copyright 2020 Falk Spickenbaum
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef HASH_INDEX_HEADER
+#define HASH_INDEX_HEADER
+#include "hash_index.hpp"
+#endif
+
+#include <chrono>
+
+// Control byte of a slot which has never been used. Used slots hold a value below 0x80:
+#define HASH_INDEX_EMPTY 0x80
+
+//! Construct an empty HashIndex object
+HashIndex::HashIndex()
+{
+    this->count = 0;
+    this->rehash(1);
+}
+
+//! hash_of(Hash256)
+/*! Returns the hash of a key, i.e. its last 8 bytes.*/
+uint64_t HashIndex::hash_of(const Hash256 &key)
+{
+    uint64_t h;
+    memcpy(&h, key.bytes + 24, sizeof(h));
+    return h;
+}
+
+//! match_group(uint64_t, uint8_t)
+/*! Returns a bit mask of the slots in a group whose control byte equals the tag.*/
+uint32_t HashIndex::match_group(uint64_t group, uint8_t tag) const
+{
+    const uint8_t *ctrl = this->control.data() + group * HASH_INDEX_GROUP_SIZE;
+
+#ifdef __SSE2__
+    __m128i bytes = _mm_loadu_si128((const __m128i *) ctrl);
+    return (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8((char) tag)));
+#else
+    uint32_t mask = 0;
+    for(int i = 0; i < HASH_INDEX_GROUP_SIZE; i++) mask |= (uint32_t) (ctrl[i] == tag) << i;
+    return mask;
+#endif
+}
+
+//! empty_in_group(uint64_t)
+/*! Returns a bit mask of the empty slots in a group.*/
+uint32_t HashIndex::empty_in_group(uint64_t group) const
+{ return this->match_group(group, HASH_INDEX_EMPTY); }
+
+//! rehash(uint64_t)
+/*! Parameters: The new number of groups, a power of two.
+Moves all entries into a table of the given size.*/
+void HashIndex::rehash(uint64_t groups)
+{
+    std::vector<uint8_t> old_control(groups * HASH_INDEX_GROUP_SIZE, HASH_INDEX_EMPTY);
+    std::vector<Entry> old_entries(groups * HASH_INDEX_GROUP_SIZE);
+
+    old_control.swap(this->control);
+    old_entries.swap(this->entries);
+    this->group_mask = groups - 1;
+    this->count = 0;
+
+    for(uint64_t i = 0; i < old_control.size(); i++)
+        if(old_control[i] != HASH_INDEX_EMPTY) this->insert(old_entries[i].key, old_entries[i].value);
+}
+
+//! insert(Hash256, uint64_t)
+/*! Parameters: A block hash and the value to be stored with it.
+Returns false, and leaves the stored value untouched, if the hash is already contained.*/
+bool HashIndex::insert(const Hash256 &key, uint64_t value)
+{
+    uint64_t found;
+    if(this->find(key, found)) return false;
+
+    // Keep at least 1/8 of the slots empty, so probes stay short:
+    if((this->count + 1) * 8 > this->capacity() * 7) this->rehash((this->group_mask + 1) * 2);
+
+    uint64_t h = hash_of(key);
+    uint64_t group = (h >> 7) & this->group_mask;
+
+    // Probe groups in triangular steps, which visits every group of a power-of-two table:
+    for(uint64_t step = 1; ; step++)
+    {
+        uint32_t empty = this->empty_in_group(group);
+
+        if(empty)
+        {
+            uint64_t slot = group * HASH_INDEX_GROUP_SIZE + __builtin_ctz(empty);
+
+            this->control[slot] = (uint8_t) (h & 0x7f);
+            this->entries[slot].key = key;
+            this->entries[slot].value = value;
+            this->count++;
+            return true;
+        }
+
+        group = (group + step) & this->group_mask;
+    }
+}
+
+//! find(Hash256, uint64_t &)
+/*! Parameters: A block hash and the value to be written.
+Returns true and writes the value stored with the hash if it is contained, else returns false.*/
+bool HashIndex::find(const Hash256 &key, uint64_t &value) const
+{
+    uint64_t h = hash_of(key);
+    uint64_t group = (h >> 7) & this->group_mask;
+
+    for(uint64_t step = 1; ; step++)
+    {
+        for(uint32_t match = this->match_group(group, (uint8_t) (h & 0x7f)); match; match &= match - 1)
+        {
+            const Entry &entry = this->entries[group * HASH_INDEX_GROUP_SIZE + __builtin_ctz(match)];
+
+            if(entry.key == key)
+            {
+                value = entry.value;
+                return true;
+            }
+        }
+
+        // Entries are never removed, so the key would have been placed in the first empty slot:
+        if(this->empty_in_group(group)) return false;
+
+        group = (group + step) & this->group_mask;
+    }
+}
+
+//! reserve(uint64_t)
+/*! Parameters: A number of entries.
+Grows the table so that it holds the given number of entries without rehashing.*/
+void HashIndex::reserve(uint64_t size)
+{
+    uint64_t groups = this->group_mask + 1;
+    while(size * 8 > groups * HASH_INDEX_GROUP_SIZE * 7) groups *= 2;
+
+    if(groups > this->group_mask + 1) this->rehash(groups);
+}
+
+//! clear(void)
+/*! Removes all entries and releases the memory of the table.*/
+void HashIndex::clear()
+{
+    std::vector<uint8_t>().swap(this->control);
+    std::vector<Entry>().swap(this->entries);
+    this->rehash(1);
+}
+
+//! size(void)
+/*! Returns the number of entries.*/
+uint64_t HashIndex::size() const
+{ return this->count; }
+
+//! capacity(void)
+/*! Returns the number of slots.*/
+uint64_t HashIndex::capacity() const
+{ return this->control.size(); }
+
+//! memory_usage(void)
+/*! Returns the number of bytes taken by the slots.*/
+uint64_t HashIndex::memory_usage() const
+{ return this->control.size() * (sizeof(uint8_t) + sizeof(Entry)); }
+
+//! next_random(uint64_t &)
+/*! SplitMix64, used to generate uniformly distributed stand-ins for block hashes.*/
+static uint64_t next_random(uint64_t &state)
+{
+    uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+//! time_lookups(vector<uint64_t>, Lookup)
+/*! Parameters: The positions of the keys to be looked up, in order, and a function looking up a key.
+Returns the mean time of a lookup in nanoseconds. The lookup returns the value found, which is
+summed up so the lookups cannot be optimized away.*/
+template <typename Lookup>
+static double time_lookups(const std::vector<uint64_t> &order, Lookup lookup)
+{
+    volatile uint64_t sink = 0;
+    uint64_t sum = 0;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for(uint64_t i = 0; i < order.size(); i++) sum += lookup(order[i]);
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    sink = sum;
+    (void) sink;
+
+    return std::chrono::duration<double, std::nano>(end - start).count() / (order.empty() ? 1 : order.size());
+}
+
+//! benchmark_hash_index(uint64_t, uint64_t)
+/*! Parameters: The number of hashes to be stored and the number of lookups to be timed.
+
+Stores the same random hashes in a HashIndex, in a std::map keyed by raw hashes and in a std::map
+keyed by hashes in hexadecimal notation, as the ledger used to be, and looks them up in the same
+random order. Returns the mean time of a lookup in nanoseconds for each, and the bytes per entry
+taken by the HashIndex.*/
+std::map<std::string, double> benchmark_hash_index(uint64_t entries, uint64_t lookups)
+{
+    uint64_t state = 1;
+    std::vector<Hash256> keys(entries);
+    std::vector<uint64_t> order(entries ? lookups : 0);
+
+    for(uint64_t i = 0; i < entries; i++)
+        for(int w = 0; w < 4; w++)
+        {
+            uint64_t r = next_random(state);
+            memcpy(keys[i].bytes + 8 * w, &r, sizeof(r));
+        }
+
+    for(uint64_t i = 0; i < order.size(); i++) order[i] = next_random(state) % entries;
+
+    HashIndex index;
+    std::map<Hash256, uint64_t> raw_map;
+    std::map<std::string, uint64_t> hex_map;
+
+    for(uint64_t i = 0; i < entries; i++)
+    {
+        index.insert(keys[i], i);
+        raw_map.insert(std::make_pair(keys[i], i));
+        hex_map.insert(std::make_pair(keys[i].to_hex(), i));
+    }
+
+    // The hexadecimal keys are converted up front, so only the lookups are timed:
+    std::vector<std::string> hex_keys(entries);
+    for(uint64_t i = 0; i < entries; i++) hex_keys[i] = keys[i].to_hex();
+
+    std::map<std::string, double> results;
+
+    results["hash_index"] = time_lookups(order, [&](uint64_t i)
+        { uint64_t value = 0; index.find(keys[i], value); return value; });
+    results["map"] = time_lookups(order, [&](uint64_t i)
+        { return raw_map.find(keys[i])->second; });
+    results["string_map"] = time_lookups(order, [&](uint64_t i)
+        { return hex_map.find(hex_keys[i])->second; });
+    results["hash_index_bytes_per_entry"] = entries ? (double) index.memory_usage() / entries : 0;
+
+    return results;
+}
+
+//! cross_check_hash_index(uint64_t)
+/*! Parameters: The number of hashes to be stored.
+
+Stores random hashes in a HashIndex which grows from its initial size, and checks it against a
+std::map holding the same hashes. Every second hash shares its last 8 bytes, i.e. its slot and
+control byte, with the one before it. Returns a map from the name of each check to its result:
+
+lookup: Every hash is found with its value, also after reserving more space.
+duplicate: Inserting a contained hash again fails and leaves its value untouched.
+missing: Hashes which are not contained are not found, even if they share their last 8 bytes with one that is.*/
+std::map<std::string, bool> cross_check_hash_index(uint64_t entries)
+{
+    uint64_t state = 2;
+    std::vector<Hash256> keys(entries), missing(entries);
+
+    for(uint64_t i = 0; i < entries; i++)
+        for(int w = 0; w < 4; w++)
+        {
+            uint64_t r = next_random(state);
+            memcpy(keys[i].bytes + 8 * w, &r, sizeof(r));
+
+            r = next_random(state);
+            memcpy(missing[i].bytes + 8 * w, &r, sizeof(r));
+        }
+
+    for(uint64_t i = 1; i < entries; i += 2) memcpy(keys[i].bytes + 24, keys[i - 1].bytes + 24, 8);
+    for(uint64_t i = 0; i < entries; i += 2) memcpy(missing[i].bytes + 24, keys[i].bytes + 24, 8);
+
+    HashIndex index;
+    std::map<Hash256, uint64_t> reference;
+    std::map<std::string, bool> results;
+
+    bool inserted = true;
+    for(uint64_t i = 0; i < entries; i++)
+        if(reference.insert(std::make_pair(keys[i], i)).second) inserted &= index.insert(keys[i], i);
+
+    // Checks that the index holds exactly the hashes of the reference, with their values:
+    auto matches = [&]()
+    {
+        if(index.size() != reference.size()) return false;
+
+        for(std::map<Hash256, uint64_t>::const_iterator it = reference.begin(); it != reference.end(); ++it)
+        {
+            uint64_t value;
+            if(!index.find(it->first, value) || value != it->second) return false;
+        }
+
+        return true;
+    };
+
+    results["lookup"] = inserted && matches();
+
+    bool rejected = true;
+    for(uint64_t i = 0; i < entries; i++) rejected &= !index.insert(keys[i], entries + i);
+    results["duplicate"] = rejected && matches();
+
+    bool absent = true;
+    for(uint64_t i = 0; i < entries; i++)
+    {
+        uint64_t value;
+        if(!reference.count(missing[i])) absent &= !index.find(missing[i], value);
+    }
+    results["missing"] = absent;
+
+    index.reserve(entries * 4);
+    results["lookup"] = results["lookup"] && matches();
+
+    return results;
+}
@@ -0,0 +1,81 @@
+// Copyright 2020 Falk Spickenbaum
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef HASH_INDEX_HPP
+#define HASH_INDEX_HPP
+
+#include <map>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "hash256.hpp"
+
+// Number of slots whose control bytes are matched at once:
+#define HASH_INDEX_GROUP_SIZE 16
+
+//! HashIndex
+/*! An open-addressing hash table from block hash to a 64 bit value, e.g. a block ID.
+
+The slots are split into groups of HASH_INDEX_GROUP_SIZE. Every slot has a control byte, which
+is either empty or holds 7 bits of the hash of its key; a probe compares the control bytes of a
+whole group against those 7 bits with a single SSE2 comparison, and only compares the 32 byte
+keys of the slots that match. Since the keys are SHA256 digests, their last 8 bytes are used as
+the hash directly. The leading bytes are not, as block hashes start with zero bits.
+
+The table holds at most 7/8 of its slots and doubles when it gets fuller, so it takes 41 bytes
+per slot and between 47 and 94 bytes per entry. Entries cannot be removed one by one.*/
+class HashIndex {
+
+    private:
+
+        struct Entry {
+            Hash256 key;
+            uint64_t value;
+        };
+
+        std::vector<uint8_t> control;
+        std::vector<Entry> entries;
+        uint64_t count;
+        uint64_t group_mask;
+
+        static uint64_t hash_of(const Hash256 &key);
+        uint32_t match_group(uint64_t group, uint8_t tag) const;
+        uint32_t empty_in_group(uint64_t group) const;
+        void rehash(uint64_t groups);
+
+    protected:
+    public:
+
+        HashIndex();
+
+        bool insert(const Hash256 &key, uint64_t value);
+        bool find(const Hash256 &key, uint64_t &value) const;
+        void reserve(uint64_t size);
+        void clear();
+
+        uint64_t size() const;
+        uint64_t capacity() const;
+        uint64_t memory_usage() const;
+};
+
+std::map<std::string, double> benchmark_hash_index(uint64_t entries, uint64_t lookups);
+std::map<std::string, bool> cross_check_hash_index(uint64_t entries);
+
+#endif
@@ -0,0 +1,80 @@
+// Copyright 2020 Falk Spickenbaum
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef INTERN_POOL_HPP
+#define INTERN_POOL_HPP
+
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+#include "hash256.hpp"
+
+//! InternPool
+/*! Keeps a single copy of each distinct value handed to intern(...), so that blocks sharing a
+value store a pointer to the same copy. Interned values stay alive as long as the pool and never
+move. Safe to be used from several threads.*/
+template <typename T>
+class InternPool {
+
+    private:
+
+        std::unordered_set<T> values;
+        mutable std::mutex mutex;
+
+    protected:
+    public:
+
+        //! intern(T)
+        /*! Parameters: A value.
+        Returns a pointer to the pooled copy of the value, which is added if it is not pooled yet.*/
+        const T *intern(const T &value)
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            return &*this->values.insert(value).first;
+        }
+
+        //! find(T)
+        /*! Parameters: A value.
+        Returns a pointer to the pooled copy of the value, NULL if it is not pooled. Unlike intern,
+        this does not add the value.*/
+        const T *find(const T &value) const
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            typename std::unordered_set<T>::const_iterator found = this->values.find(value);
+
+            return (found == this->values.end()) ? NULL : &*found;
+        }
+
+        //! size(void)
+        /*! Returns the number of distinct values pooled.*/
+        size_t size() const
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            return this->values.size();
+        }
+};
+
+//! TagPools
+/*! The values shared by the blocks of a chain: the addresses of the nodes which mined them, their
+metadata tags and the blockchain IDs. Each chain has its own pools, which are released with it.*/
+struct TagPools {
+
+    InternPool<std::string> node_addresses;
+    InternPool<std::string> meta_tags;
+    InternPool<Hash256> blockchain_ids;
+};
+
+#endif
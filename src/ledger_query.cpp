@@ -0,0 +1,224 @@
+// Copyright 2020 Falk Spickenbaum
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef LEDGER_QUERY_HEADER
+#define LEDGER_QUERY_HEADER
+#include "ledger_query.hpp"
+#endif
+
+#include <algorithm>
+#include <cstring>
+
+//! Construct a LedgerQuery object
+/*! Parameters: The storage of the ledger to be queried, which has to outlive the query.
+A query without filters matches every block.*/
+LedgerQuery::LedgerQuery(const LedgerStore *store)
+    : store(store), by_meta(false), by_node(false), by_time(false), reversed(false),
+      first_height(0), last_height(UINT64_MAX), start_time(0), end_time(UINT64_MAX)
+{}
+
+//! meta(string)
+/*! Parameters: A metadata tag.
+Only matches blocks carrying the tag. Returns the query itself.*/
+LedgerQuery &LedgerQuery::meta(const std::string &meta_data)
+{
+    this->by_meta = true;
+    this->meta_data = meta_data;
+    return *this;
+}
+
+//! node(string)
+/*! Parameters: A node address.
+Only matches blocks mined by the node. Returns the query itself.*/
+LedgerQuery &LedgerQuery::node(const std::string &node_address)
+{
+    this->by_node = true;
+    this->node_address = node_address;
+    return *this;
+}
+
+//! heights(uint64_t, uint64_t)
+/*! Parameters: The first block ID and the block ID after the last one to be matched.
+Only matches blocks with first <= block ID < last. Returns the query itself.*/
+LedgerQuery &LedgerQuery::heights(uint64_t first, uint64_t last)
+{
+    this->first_height = std::max(this->first_height, first);
+    this->last_height = std::min(this->last_height, last);
+    return *this;
+}
+
+//! time(uint64_t, uint64_t)
+/*! Parameters: The earliest UNIX timestamp in milliseconds and the one after the latest to be matched.
+Only matches blocks with start <= timestamp < end. Returns the query itself.*/
+LedgerQuery &LedgerQuery::time(uint64_t start, uint64_t end)
+{
+    this->by_time = true;
+    this->start_time = std::max(this->start_time, start);
+    this->end_time = std::min(this->end_time, end);
+    return *this;
+}
+
+//! prefix(string)
+/*! Parameters: A string of bytes.
+Only matches blocks whose data starts with the given bytes. Returns the query itself.*/
+LedgerQuery &LedgerQuery::prefix(const std::string &data_prefix)
+{
+    this->data_prefix = data_prefix;
+    return *this;
+}
+
+//! reverse(bool)
+/*! Parameters: If true, the newest blocks come first.
+Returns the query itself.*/
+LedgerQuery &LedgerQuery::reverse(bool reversed)
+{
+    this->reversed = reversed;
+    return *this;
+}
+
+//! open(void)
+/*! Returns a cursor at the first block matched by the query.*/
+LedgerCursor LedgerQuery::open() const
+{ return LedgerCursor(*this); }
+
+//! count(void)
+/*! Returns the number of blocks matched by the query. Only the candidates of the most selective
+index are read.*/
+uint64_t LedgerQuery::count() const
+{
+    LedgerCursor cursor(*this);
+    uint64_t count = 0;
+
+    while(cursor.next()) count++;
+    return count;
+}
+
+//! Construct a LedgerCursor object
+/*! Parameters: The query to be read.
+Narrows the heights down by the height and time filters and picks the index with the fewest
+candidates within them. Tags that were never interned cannot be carried by any block, so a
+filter on such a tag leaves no candidates.*/
+LedgerCursor::LedgerCursor(const LedgerQuery &query)
+    : query(query), meta_tag(NULL), node_tag(NULL), index(NULL), index_tag(NULL), plan("heights"),
+      first(query.first_height), last(std::min(query.last_height, query.store->size())), position(0)
+{
+    if(query.by_time)
+    {
+        uint64_t first, last;
+        query.store->time_window(query.start_time, query.end_time, first, last);
+
+        this->first = std::max(this->first, first);
+        this->last = std::min(this->last, last);
+    }
+
+    if(this->first > this->last) this->first = this->last;
+    if(query.by_meta) this->meta_tag = query.store->find_meta_tag(query.meta_data);
+    if(query.by_node) this->node_tag = query.store->find_node_tag(query.node_address);
+
+    uint64_t first_height = this->first, last_height = this->last;
+
+    // Candidates of each index, as positions within its list of heights:
+    const std::vector<uint64_t> *(LedgerStore::*indexes[2])(const std::string *) const =
+        { &LedgerStore::meta_heights, &LedgerStore::node_heights };
+    const std::string *tags[2] = { this->meta_tag, this->node_tag };
+    const char *plans[2] = { "meta", "node" };
+    bool used[2] = { query.by_meta, query.by_node };
+
+    for(int i = 0; i < 2; i++)
+    {
+        if(!used[i]) continue;
+
+        const std::vector<uint64_t> *heights = (query.store->*indexes[i])(tags[i]);
+        uint64_t first = 0, last = 0;
+
+        if(heights)
+        {
+            first = std::lower_bound(heights->begin(), heights->end(), first_height) - heights->begin();
+            last = std::lower_bound(heights->begin(), heights->end(), last_height) - heights->begin();
+        }
+
+        if(last - first < this->get_candidates())
+        {
+            this->index = indexes[i];
+            this->index_tag = tags[i];
+            this->plan = plans[i];
+            this->first = first;
+            this->last = last;
+        }
+    }
+}
+
+//! matches(Block *)
+/*! Parameters: A candidate block.
+Returns true if the block passes every filter of the query. Heights have been narrowed down already.*/
+bool LedgerCursor::matches(Block *block) const
+{
+    if(this->query.by_meta && block->get_meta_tag() != this->meta_tag) return false;
+    if(this->query.by_node && block->get_node_tag() != this->node_tag) return false;
+
+    if(this->query.by_time && (block->get_timestamp() < this->query.start_time ||
+                               block->get_timestamp() >= this->query.end_time)) return false;
+
+    const std::string &prefix = this->query.data_prefix;
+    return block->get_data_size() >= prefix.size() &&
+           !memcmp(block->get_data_pointer(), prefix.data(), prefix.size());
+}
+
+//! next(void)
+/*! Returns the next block matched by the query, NULL once all have been read.*/
+Block *LedgerCursor::next()
+{
+    // The list of heights is looked up again on every call, as the index may have been rebuilt:
+    const std::vector<uint64_t> *heights = this->index ? (this->query.store->*this->index)(this->index_tag) : NULL;
+    uint64_t size = this->query.store->size();
+
+    while(this->position < this->last - this->first)
+    {
+        uint64_t i = this->query.reversed ? this->last - 1 - this->position : this->first + this->position;
+        this->position++;
+
+        if(this->index && (!heights || i >= heights->size())) continue;
+
+        uint64_t height = this->index ? (*heights)[i] : i;
+        if(height >= size) continue;
+
+        Block *block = this->query.store->at(height);
+        if(this->matches(block)) return block;
+    }
+
+    return NULL;
+}
+
+//! next_batch(uint64_t)
+/*! Parameters: The maximum number of blocks to be returned.
+Returns the next blocks matched by the query, fewer than requested once all have been read.*/
+std::vector<Block *> LedgerCursor::next_batch(uint64_t size)
+{
+    std::vector<Block *> batch;
+    Block *block;
+
+    while(batch.size() < size && (block = this->next())) batch.push_back(block);
+    return batch;
+}
+
+//! get_plan(void)
+/*! Returns the index the cursor reads: "meta", "node" or "heights" for the range of heights.*/
+const std::string &LedgerCursor::get_plan() const
+{ return this->plan; }
+
+//! get_candidates(void)
+/*! Returns the number of blocks the cursor reads at most.*/
+uint64_t LedgerCursor::get_candidates() const
+{ return this->last - this->first; }
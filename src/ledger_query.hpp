@@ -0,0 +1,106 @@
+// Copyright 2020 Falk Spickenbaum
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef LEDGER_QUERY_HPP
+#define LEDGER_QUERY_HPP
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#ifndef LEDGER_STORE_HEADER
+#define LEDGER_STORE_HEADER
+#include "ledger_store.hpp"
+#endif
+
+class LedgerCursor;
+
+//! LedgerQuery
+/*! Describes a set of blocks of a ledger by combining filters on metadata tag, node address,
+height range, time range and data prefix. Each filter narrows down the previous ones. A query is
+only a description: it does not touch the ledger until it is opened, which yields a LedgerCursor.
+Like a LedgerView, a query borrows the storage of the chain and must not outlive it.*/
+class LedgerQuery {
+
+    private:
+
+        const LedgerStore *store;
+
+        bool by_meta;
+        bool by_node;
+        bool by_time;
+        bool reversed;
+        std::string meta_data;
+        std::string node_address;
+        std::string data_prefix;
+        uint64_t first_height;
+        uint64_t last_height;
+        uint64_t start_time;
+        uint64_t end_time;
+
+        friend class LedgerCursor;
+
+    protected:
+    public:
+
+        LedgerQuery(const LedgerStore *store);
+
+        LedgerQuery &meta(const std::string &meta_data);
+        LedgerQuery &node(const std::string &node_address);
+        LedgerQuery &heights(uint64_t first, uint64_t last);
+        LedgerQuery &time(uint64_t start, uint64_t end);
+        LedgerQuery &prefix(const std::string &data_prefix);
+        LedgerQuery &reverse(bool reversed);
+
+        LedgerCursor open() const;
+        uint64_t count() const;
+};
+
+//! LedgerCursor
+/*! Reads the blocks matched by a LedgerQuery in ascending order of height, or descending if the
+query is reversed. On opening, the cursor picks the index which leaves the fewest candidates:
+the heights of a metadata tag, the heights of a node address, or the range of heights left by the
+height and time filters. Only the candidates are read, and only as far as blocks are requested,
+so taking the first few matches of a large query is cheap. Blocks appended after opening are not
+reached.*/
+class LedgerCursor {
+
+    private:
+
+        LedgerQuery query;
+        const std::string *meta_tag;
+        const std::string *node_tag;
+        const std::vector<uint64_t> *(LedgerStore::*index)(const std::string *) const;
+        const std::string *index_tag;
+        std::string plan;
+        uint64_t first;
+        uint64_t last;
+        uint64_t position;
+
+        bool matches(Block *block) const;
+
+    protected:
+    public:
+
+        LedgerCursor(const LedgerQuery &query);
+
+        Block *next();
+        std::vector<Block *> next_batch(uint64_t size);
+
+        const std::string &get_plan() const;
+        uint64_t get_candidates() const;
+};
+
+#endif
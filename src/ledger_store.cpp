@@ -0,0 +1,222 @@
+// Copyright 2020 Falk Spickenbaum
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LEDGER_STORE_HEADER
+#define LEDGER_STORE_HEADER
+#include "ledger_store.hpp"
+#endif
+
+//! LedgerStore(const TagPools *)
+/*! Parameters: The pools the tags of the blocks to be stored are interned in, if any.
+Construct an empty LedgerStore object.*/
+LedgerStore::LedgerStore(const TagPools *pools = NULL)
+{ this->pools = pools; }
+
+//! append(Block *)
+/*! Parameters: A Block object whose block ID equals the current size of the store.
+Appends a block on top of the last block. The store does not check the block otherwise.
+Returns false if the block ID does not fit, or a block with the same hash is already stored.*/
+bool LedgerStore::append(Block *block)
+{
+    if(block->get_block_id() != this->blocks.size()) return false;
+    // Throws before anything is changed if the block cannot be counted:
+    ChainWork work = this->work;
+    work.add_block(block->get_difficulty());
+
+    if(!this->heights.insert(block->get_block_hash(), this->blocks.size())) return false;
+
+    this->blocks.push_back(block);
+    this->meta_index.add(block->get_meta_tag(), block->get_block_id());
+    this->node_index.add(block->get_node_tag(), block->get_block_id());
+    this->time_index.add(block->get_timestamp());
+    this->difficulties[block->get_difficulty()]++;
+    this->work = work;
+    return true;
+}
+
+//! retag(Block *, const string *, const string *)
+/*! Parameters: A Block object whose tags have been changed, and its node address and metadata tag before.
+Moves the block from the old tags to the new ones within the indexes, if the block is stored here.*/
+void LedgerStore::retag(Block *block, const std::string *old_node_tag, const std::string *old_meta_tag)
+{
+    uint64_t height;
+
+    if(!this->heights.find(block->get_block_hash(), height) || this->blocks[height] != block) return;
+
+    this->meta_index.move(old_meta_tag, block->get_meta_tag(), height);
+    this->node_index.move(old_node_tag, block->get_node_tag(), height);
+}
+
+//! clear(void)
+/*! Removes all blocks from the store. The Block objects themselves are not deleted.*/
+void LedgerStore::clear()
+{
+    this->blocks.clear();
+    this->heights.clear();
+    this->meta_index.clear();
+    this->node_index.clear();
+    this->time_index.clear();
+    this->difficulties.clear();
+    this->work = ChainWork();
+}
+
+//! find(Hash256)
+/*! Parameters: A block hash.
+Returns the Block object with the given hash, NULL if it is not stored.*/
+Block *LedgerStore::find(const Hash256 &hash) const
+{
+    uint64_t height;
+    return this->heights.find(hash, height) ? this->blocks[height] : NULL;
+}
+
+//! at(uint64_t)
+/*! Parameters: A block ID.
+Returns the Block object with the given block ID, NULL if the ID exceeds the last one.*/
+Block *LedgerStore::at(uint64_t height) const
+{ return (height < this->blocks.size()) ? this->blocks[height] : NULL; }
+
+//! tip(void)
+/*! Returns the block with the highest block ID, NULL if the store is empty.*/
+Block *LedgerStore::tip() const
+{ return this->blocks.empty() ? NULL : this->blocks.back(); }
+
+//! size(void)
+/*! Returns the number of blocks stored.*/
+uint64_t LedgerStore::size() const
+{ return this->blocks.size(); }
+
+//! get_work(void)
+/*! Returns the cumulative work of the stored blocks.*/
+const ChainWork &LedgerStore::get_work() const
+{ return this->work; }
+
+//! range(uint64_t, uint64_t)
+/*! Parameters: The block ID of the first block and the number of blocks.
+Returns the blocks in ascending order. Throws an out_of_range exception if the range exceeds the store.*/
+std::vector<Block *> LedgerStore::range(uint64_t first, uint64_t count) const
+{
+    if(first > this->blocks.size() || count > this->blocks.size() - first)
+        throw std::out_of_range("Requested range exceeds size of ledger.");
+
+    return std::vector<Block *>(this->blocks.begin() + first, this->blocks.begin() + first + count);
+}
+
+//! blocks_at(vector<uint64_t>)
+/*! Parameters: A list of heights.
+Returns the blocks at the given heights, in the same order.*/
+std::vector<Block *> LedgerStore::blocks_at(const std::vector<uint64_t> &heights) const
+{
+    std::vector<Block *> blocks(heights.size());
+
+    for(uint64_t i = 0; i < heights.size(); i++) blocks[i] = this->blocks[heights[i]];
+    return blocks;
+}
+
+//! find_meta_tag(string)
+/*! Parameters: A metadata tag.
+Returns the interned copy of the tag the stored blocks carry, NULL if no block carries it.*/
+const std::string *LedgerStore::find_meta_tag(const std::string &meta) const
+{ return this->pools ? this->pools->meta_tags.find(meta) : NULL; }
+
+//! find_node_tag(string)
+/*! Parameters: A node address.
+Returns the interned copy of the address the stored blocks carry, NULL if no block was mined by the node.*/
+const std::string *LedgerStore::find_node_tag(const std::string &node_address) const
+{ return this->pools ? this->pools->node_addresses.find(node_address) : NULL; }
+
+//! count_by_meta(string)
+/*! Parameters: A metadata tag.
+Returns the number of blocks carrying the tag.*/
+uint64_t LedgerStore::count_by_meta(const std::string &meta) const
+{ return this->meta_index.count(this->find_meta_tag(meta)); }
+
+//! find_by_meta(string, uint64_t, uint64_t, bool)
+/*! Parameters: A metadata tag, the number of matching blocks to be skipped, the maximum number of
+blocks to be returned and whether the newest blocks come first.
+Returns a page of the blocks carrying the tag, ordered by block ID. Takes time proportional to the
+size of the page.*/
+std::vector<Block *> LedgerStore::find_by_meta(const std::string &meta, uint64_t offset, uint64_t limit,
+                                               bool reverse) const
+{ return this->blocks_at(this->meta_index.find(this->find_meta_tag(meta), offset, limit, reverse)); }
+
+//! count_by_node(string)
+/*! Parameters: A node address.
+Returns the number of blocks mined by the node.*/
+uint64_t LedgerStore::count_by_node(const std::string &node_address) const
+{ return this->node_index.count(this->find_node_tag(node_address)); }
+
+//! find_by_node(string, uint64_t, uint64_t, bool)
+/*! Parameters: A node address, the number of matching blocks to be skipped, the maximum number of
+blocks to be returned and whether the newest blocks come first.
+Returns a page of the blocks mined by the node, ordered by block ID. Takes time proportional to the
+size of the page.*/
+std::vector<Block *> LedgerStore::find_by_node(const std::string &node_address, uint64_t offset,
+                                               uint64_t limit, bool reverse) const
+{ return this->blocks_at(this->node_index.find(this->find_node_tag(node_address), offset, limit, reverse)); }
+
+//! find_by_time(uint64_t, uint64_t, uint64_t, uint64_t, bool)
+/*! Parameters: The earliest timestamp and the timestamp after the latest one to be matched, the number
+of matching blocks to be skipped, the maximum number of blocks to be returned and whether the newest
+blocks come first.
+Returns a page of the blocks within the time window, ordered by block ID.*/
+std::vector<Block *> LedgerStore::find_by_time(uint64_t start, uint64_t end, uint64_t offset, uint64_t limit,
+                                               bool reverse) const
+{ return this->blocks_at(this->time_index.find(start, end, offset, limit, reverse)); }
+
+//! meta_heights(const string *)
+/*! Parameters: An interned metadata tag, or NULL.
+Returns the heights of the blocks carrying the tag in ascending order, NULL if there are none.*/
+const std::vector<uint64_t> *LedgerStore::meta_heights(const std::string *meta_tag) const
+{ return this->meta_index.get(meta_tag); }
+
+//! node_heights(const string *)
+/*! Parameters: An interned node address, or NULL.
+Returns the heights of the blocks mined by the node in ascending order, NULL if there are none.*/
+const std::vector<uint64_t> *LedgerStore::node_heights(const std::string *node_tag) const
+{ return this->node_index.get(node_tag); }
+
+//! time_window(uint64_t, uint64_t, uint64_t &, uint64_t &)
+/*! Parameters: The earliest timestamp and the timestamp after the latest one to be matched, and the
+first and last height of the window, which are set.
+Narrows down the heights of the blocks within the time window to first <= height < last.*/
+void LedgerStore::time_window(uint64_t start, uint64_t end, uint64_t &first, uint64_t &last) const
+{ this->time_index.window(start, end, first, last); }
+
+//! meta_counts(void)
+/*! Returns the number of blocks per metadata tag.*/
+std::map<std::string, uint64_t> LedgerStore::meta_counts() const
+{ return this->meta_index.counts(); }
+
+//! node_counts(void)
+/*! Returns the number of blocks per node address.*/
+std::map<std::string, uint64_t> LedgerStore::node_counts() const
+{ return this->node_index.counts(); }
+
+//! difficulty_counts(void)
+/*! Returns the number of blocks per difficulty.*/
+const std::map<uint64_t, uint64_t> &LedgerStore::difficulty_counts() const
+{ return this->difficulties; }
+
+//! time_histogram(uint64_t, uint64_t, uint64_t)
+/*! Parameters: The earliest timestamp and the timestamp after the latest one to be counted, and the
+width of a bucket.
+Returns the number of blocks per bucket of time, keyed by the earliest timestamp of the bucket.*/
+std::map<uint64_t, uint64_t> LedgerStore::time_histogram(uint64_t start, uint64_t end, uint64_t bucket) const
+{ return this->time_index.histogram(start, end, bucket); }
+
+//! block_time_stats(uint64_t)
+/*! Parameters: The number of newest blocks to be covered.
+Returns the statistics of the times between consecutive blocks among them.*/
+BlockTimeStats LedgerStore::block_time_stats(uint64_t window) const
+{ return this->time_index.interval_stats(window); }
@@ -0,0 +1,110 @@
+// Copyright 2020 Falk Spickenbaum
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LEDGER_STORE_HPP
+#define LEDGER_STORE_HPP
+
+#include <map>
+#include <vector>
+#include <stdint.h>
+
+#ifndef BLOCK_HEADER
+#define BLOCK_HEADER
+#include "block.hpp"
+#endif
+
+#ifndef HASH_INDEX_HEADER
+#define HASH_INDEX_HEADER
+#include "hash_index.hpp"
+#endif
+
+#ifndef TAG_INDEX_HEADER
+#define TAG_INDEX_HEADER
+#include "tag_index.hpp"
+#endif
+
+#ifndef TIME_INDEX_HEADER
+#define TIME_INDEX_HEADER
+#include "time_index.hpp"
+#endif
+
+#ifndef CHAIN_WORK_HEADER
+#define CHAIN_WORK_HEADER
+#include "chain_work.hpp"
+#endif
+
+//! LedgerStore
+/*! Stores the blocks of a chain in a vector ordered by height, i.e. the block at position i has
+the block ID i, next to an index from block hash to height. The last block, a block at a given
+height and a range of blocks are found without searching, a block with a given hash through
+the index, an open-addressing table keyed by the digest. The cumulative work of the stored blocks
+and indexes from metadata tag, node address and timestamp to heights are kept up to date on every append,
+as is the number of blocks per difficulty. The tags are those interned in the pools of the chain the
+blocks belong to.*/
+class LedgerStore {
+
+    private:
+
+        std::vector<Block *> blocks;
+        HashIndex heights;
+        TagIndex meta_index;
+        TagIndex node_index;
+        TimeIndex time_index;
+        std::map<uint64_t, uint64_t> difficulties;
+        ChainWork work;
+        const TagPools *pools;
+
+        std::vector<Block *> blocks_at(const std::vector<uint64_t> &heights) const;
+
+    protected:
+    public:
+
+        LedgerStore(const TagPools *pools);
+
+        bool append(Block *block);
+        void retag(Block *block, const std::string *old_node_tag, const std::string *old_meta_tag);
+        void clear();
+
+        Block *find(const Hash256 &hash) const;
+        Block *at(uint64_t height) const;
+        Block *tip() const;
+        uint64_t size() const;
+        const ChainWork &get_work() const;
+        std::vector<Block *> range(uint64_t first, uint64_t count) const;
+
+        uint64_t count_by_meta(const std::string &meta) const;
+        std::vector<Block *> find_by_meta(const std::string &meta, uint64_t offset, uint64_t limit,
+                                          bool reverse) const;
+
+        uint64_t count_by_node(const std::string &node_address) const;
+        std::vector<Block *> find_by_node(const std::string &node_address, uint64_t offset, uint64_t limit,
+                                          bool reverse) const;
+
+        std::vector<Block *> find_by_time(uint64_t start, uint64_t end, uint64_t offset, uint64_t limit,
+                                          bool reverse) const;
+
+        const std::string *find_meta_tag(const std::string &meta) const;
+        const std::string *find_node_tag(const std::string &node_address) const;
+        const std::vector<uint64_t> *meta_heights(const std::string *meta_tag) const;
+        const std::vector<uint64_t> *node_heights(const std::string *node_tag) const;
+        void time_window(uint64_t start, uint64_t end, uint64_t &first, uint64_t &last) const;
+
+        std::map<std::string, uint64_t> meta_counts() const;
+        std::map<std::string, uint64_t> node_counts() const;
+        const std::map<uint64_t, uint64_t> &difficulty_counts() const;
+        std::map<uint64_t, uint64_t> time_histogram(uint64_t start, uint64_t end, uint64_t bucket) const;
+        BlockTimeStats block_time_stats(uint64_t window) const;
+};
+
+#endif
@@ -0,0 +1,73 @@
+// Copyright 2020 Falk Spickenbaum
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef LEDGER_VIEW_HEADER
+#define LEDGER_VIEW_HEADER
+#include "ledger_view.hpp"
+#endif
+
+//! Construct a LedgerView object
+/*! Parameters: The storage of the ledger to be viewed, which has to outlive the view.*/
+LedgerView::LedgerView(const LedgerStore *store)
+{
+    this->store = store;
+}
+
+//! size(void)
+/*! Returns the number of blocks in the ledger.*/
+uint64_t LedgerView::size() const
+{ return this->store->size(); }
+
+//! at(uint64_t)
+/*! Parameters: A block ID.
+Returns the Block object with the given block ID. Throws an out_of_range exception if the ID
+exceeds the last one.*/
+Block *LedgerView::at(uint64_t height) const
+{
+    if(height >= this->store->size())
+        throw std::out_of_range("Requested index exceeds size of ledger.");
+
+    return this->store->at(height);
+}
+
+//! find(Hash256)
+/*! Parameters: A block hash.
+Returns the Block object with the given hash, NULL if the ledger does not contain it.*/
+Block *LedgerView::find(const Hash256 &hash) const
+{ return this->store->find(hash); }
+
+//! begin(void)
+/*! Returns an iterator to the Genesis block.*/
+LedgerView::iterator LedgerView::begin() const
+{ return iterator(this->store, 0); }
+
+//! end(void)
+/*! Returns an iterator behind the last block. Blocks appended later are not reached.*/
+LedgerView::iterator LedgerView::end() const
+{ return iterator(this->store, this->store->size()); }
+
+//! begin(uint64_t, int64_t)
+/*! Parameters: The block ID of the first block and the distance between the block IDs of two
+consecutive blocks, negative to iterate downwards.
+Returns an iterator to the first block.*/
+LedgerView::iterator LedgerView::begin(uint64_t height, int64_t step) const
+{ return iterator(this->store, height, step); }
+
+//! end(uint64_t, uint64_t, int64_t)
+/*! Parameters: The block ID of the first block, the number of blocks and the distance between the
+block IDs of two consecutive blocks.
+Returns an iterator behind the last of the blocks. The caller makes sure they exist in the ledger.*/
+LedgerView::iterator LedgerView::end(uint64_t height, uint64_t count, int64_t step) const
+{ return iterator(this->store, height + count * (uint64_t) step, step); }
@@ -0,0 +1,83 @@
+// Copyright 2020 Falk Spickenbaum
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef LEDGER_VIEW_HPP
+#define LEDGER_VIEW_HPP
+
+#include <iterator>
+#include <stdint.h>
+
+#ifndef LEDGER_STORE_HEADER
+#define LEDGER_STORE_HEADER
+#include "ledger_store.hpp"
+#endif
+
+//! LedgerView
+/*! A read-only view of the ledger of a Blockchain object. The view borrows the storage of the
+chain instead of copying it, so it always shows the current ledger and must not outlive the
+chain. Blocks are reached by height or by hash, or iterated in order of height.*/
+class LedgerView {
+
+    private:
+
+        const LedgerStore *store;
+
+    protected:
+    public:
+
+        //! iterator
+        /*! Iterates over the blocks by height, every step-th block, downwards if the step is
+        negative. It holds a height rather than a pointer into the storage, so blocks appended while
+        iterating do not invalidate it, and iterating takes constant memory.*/
+        class iterator : public std::iterator<std::forward_iterator_tag, Block *> {
+
+            private:
+
+                const LedgerStore *store;
+                uint64_t height;
+                int64_t step;
+
+            public:
+
+                iterator(const LedgerStore *store, uint64_t height, int64_t step = 1)
+                { this->store = store; this->height = height; this->step = step; }
+
+                Block *operator*() const
+                { return this->store->at(this->height); }
+
+                // Heights wrap around below 0, so an iterator may end just below the Genesis block:
+                iterator &operator++()
+                { this->height += (uint64_t) this->step; return *this; }
+
+                bool operator==(const iterator &other) const
+                { return this->height == other.height; }
+
+                bool operator!=(const iterator &other) const
+                { return this->height != other.height; }
+        };
+
+        LedgerView(const LedgerStore *store);
+
+        uint64_t size() const;
+        Block *at(uint64_t height) const;
+        Block *find(const Hash256 &hash) const;
+
+        iterator begin() const;
+        iterator end() const;
+        iterator begin(uint64_t height, int64_t step) const;
+        iterator end(uint64_t height, uint64_t count, int64_t step) const;
+};
+
+#endif
@@ -0,0 +1,157 @@
+// Copyright 2020 Falk Spickenbaum
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MINING_TEMPLATE_HEADER
+#define MINING_TEMPLATE_HEADER
+#include "mining_template.hpp"
+#endif
+
+//! header_prefix(BlockHeader)
+/*! Returns the serialized header without its nonce, which the midstate of a template is computed over.*/
+static std::string header_prefix(const BlockHeader &header)
+{ return header.serialize().substr(0, BLOCK_HEADER_NONCE_OFFSET); }
+
+//! Construct a MiningTemplate object
+/*! Parameters:
+
+prev: The Block object the new block is mined on.
+data, node_address, meta_data: The payload of the new block.
+difficulty: The difficulty the new block has to satisfy.
+blockchain_id: The ID of the blockchain the new block is mined on.
+
+Hashes the payload and the constant part of the header. The timestamp is taken once here,
+so every nonce tried on this template shares it.*/
+MiningTemplate::MiningTemplate(Block *prev, std::string data, std::string node_address,
+                               std::string meta_data, long unsigned int difficulty,
+                               Hash256 blockchain_id)
+    : header(Block::make_header(prev, node_address, meta_data, data.data(), data.size(), 0, difficulty,
+                                Block::generate_timestamp())),
+      midstate(header_prefix(header)), target(difficulty)
+{
+    this->prev = prev;
+    this->data = data;
+    this->node_address = node_address;
+    this->meta_data = meta_data;
+    this->blockchain_id = blockchain_id;
+}
+
+//! prepare(Sha256NonceBuffer &)
+/*! Parameters: The buffer of a worker.
+Fills the buffer, after which try_nonces only writes the nonce bytes into it.*/
+void MiningTemplate::prepare(Sha256NonceBuffer &buffer) const
+{ this->midstate.prepare(buffer); }
+
+//! try_nonces(Sha256NonceBuffer &, uint64_t, unsigned int, uint64_t &)
+/*! Parameters:
+
+buffer: A buffer that has been filled by prepare.
+nonce: The first nonce of the batch.
+count: The number of consecutive nonces to be tried, at most SHA256_MAX_LANES.
+found: Receives the nonce which satisfies the difficulty.
+
+Hashes a batch of candidate nonces at once using the multi-buffer SHA256 kernel. Candidates are
+rejected on the first word of their digest where possible.
+Returns true on success, false if no nonce in the batch satisfies the difficulty.*/
+bool MiningTemplate::try_nonces(Sha256NonceBuffer &buffer, uint64_t nonce, unsigned int count,
+                                uint64_t &found) const
+{
+    Hash256 digests[SHA256_MAX_LANES];
+    unsigned int candidates = this->midstate.finish_multi(buffer, nonce, count, digests,
+                                                          this->target.first_word_max);
+
+    for(unsigned int i = 0; candidates; i++, candidates >>= 1)
+    {
+        if(!(candidates & 1) || !this->target.is_satisfied(digests[i])) continue;
+
+        // Hash the header of the winning nonce once more on the single message kernel:
+        BlockHeader header = this->header;
+        header.nonce = nonce + i;
+
+        Hash256 hash = header.hash();
+        if(hash != digests[i] || !hash_meets_difficulty(hash, header.difficulty)) continue;
+
+        found = nonce + i;
+        return true;
+    }
+
+    return false;
+}
+
+//! materialize(uint64_t, BlockArena &)
+/*! Parameters: A nonce and the arena of the chain the block is mined on.
+Returns a new Block object built from this template and the given nonce, owned by the arena.*/
+Block *MiningTemplate::materialize(uint64_t nonce, BlockArena &arena) const
+{
+    BlockHeader header = this->header;
+    header.nonce = nonce;
+
+    return arena.create(header, this->data.data(), this->data.size(), this->node_address,
+                        this->blockchain_id, this->meta_data);
+}
+
+//! get_prev(void)
+/*! Returns the Block object the new block is mined on.*/
+Block *MiningTemplate::get_prev() const
+{ return this->prev; }
+
+//! get_lanes(void)
+/*! Returns the number of nonces that are hashed at once by the engine of this template.*/
+unsigned int MiningTemplate::get_lanes() const
+{ return this->midstate.engine->lanes; }
+
+//! Construct a MiningToken object
+MiningToken::MiningToken()
+    : cancelled(false), found(false)
+{
+    this->winner = 0;
+}
+
+//! submit(uint64_t)
+/*! Parameters: A nonce which satisfies the difficulty.
+Makes the nonce the winner of the attempt unless another nonce has been submitted before,
+and cancels the attempt.
+Returns true if the nonce has won.*/
+bool MiningToken::submit(uint64_t nonce)
+{
+    bool expected = false;
+    bool won = this->found.compare_exchange_strong(expected, true);
+
+    // Only the winner writes the nonce. It is read once all workers have returned:
+    if(won) this->winner = nonce;
+
+    this->cancel();
+    return won;
+}
+
+//! cancel(void)
+/*! Tells all workers to stop.*/
+void MiningToken::cancel()
+{ this->cancelled.store(true, std::memory_order_release); }
+
+//! is_cancelled(void)
+/*! Returns true once a block has been found or the attempt has been cancelled.*/
+bool MiningToken::is_cancelled() const
+{ return this->cancelled.load(std::memory_order_acquire); }
+
+//! get_winner(uint64_t &)
+/*! Parameters: The nonce to be written.
+Writes the nonce that has won the attempt and returns true, or returns false if none has been found.
+Must only be called once the workers have returned.*/
+bool MiningToken::get_winner(uint64_t &nonce) const
+{
+    if(!this->found.load()) return false;
+
+    nonce = this->winner;
+    return true;
+}
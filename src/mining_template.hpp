@@ -0,0 +1,94 @@
+// Copyright 2020 Falk Spickenbaum
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MINING_TEMPLATE_HPP
+#define MINING_TEMPLATE_HPP
+
+#include <atomic>
+#include <string>
+#include <stdint.h>
+
+#ifndef BLOCK_HEADER
+#define BLOCK_HEADER
+#include "block.hpp"
+#endif
+
+#ifndef POW_HEADER
+#define POW_HEADER
+#include "pow_util.hpp"
+#endif
+
+#ifndef BLOCK_ARENA_HEADER
+#define BLOCK_ARENA_HEADER
+#include "block_arena.hpp"
+#endif
+
+//! MiningTemplate
+/*! Everything that stays constant while a block is mined: the payload, the header without its nonce,
+the SHA256 midstate over that header and the proof-of-work target. A template is built once per
+block and may be shared by any number of workers, each of which hashes nonces in its own
+Sha256NonceBuffer. A Block object is only created for the winning nonce, once the workers are done.*/
+class MiningTemplate {
+
+    private:
+
+        Block *prev;
+        std::string data;
+        std::string node_address;
+        std::string meta_data;
+        Hash256 blockchain_id;
+
+        BlockHeader header;
+        Sha256Midstate midstate;
+        PowTarget target;
+
+    protected:
+    public:
+
+        MiningTemplate(Block *prev, std::string data, std::string node_address,
+                       std::string meta_data, long unsigned int difficulty, Hash256 blockchain_id);
+
+        void prepare(Sha256NonceBuffer &buffer) const;
+        bool try_nonces(Sha256NonceBuffer &buffer, uint64_t nonce, unsigned int count, uint64_t &found) const;
+        Block *materialize(uint64_t nonce, BlockArena &arena) const;
+
+        Block *get_prev() const;
+        unsigned int get_lanes() const;
+};
+
+//! MiningToken
+/*! Shared by all workers mining the same block. The first worker to find a valid nonce submits it,
+which cancels the attempt for everyone else. Workers check the token after every batch of nonces,
+so they stop within a few microseconds, without having to look at the ledger.*/
+class MiningToken {
+
+    private:
+
+        std::atomic<bool> cancelled;
+        std::atomic<bool> found;
+        uint64_t winner;
+
+    protected:
+    public:
+
+        MiningToken();
+
+        bool submit(uint64_t nonce);
+        void cancel();
+
+        bool is_cancelled() const;
+        bool get_winner(uint64_t &nonce) const;
+};
+
+#endif
@@ -59,19 +59,14 @@ bool Node::write_data(string data, Blockchain *chain, int try_limit = 20,
 {
     Block *block = NULL;
 
-    // Try to mine block:
-    if(threads == 0 || threads == 1) block = chain->mine_block(data, this->node_address, meta_data);
-    else block = chain->mine_block_concurrently(data, this->node_address, meta_data, threads);
-
-    // If block is still NULL, retry until try limit has been reached:
-    if(!block) 
+    // Try to mine block, retry until try limit has been reached:
+    for(int tries = 0; !block; tries++)
     {
-        if(this->tries++ >= try_limit) return false;
-        this->write_data(data, chain, try_limit, meta_data);
-    }
+        if(tries > try_limit) return false;
 
-    //! Reset try counter:
-    this->tries = 0;
+        if(threads == 0 || threads == 1) block = chain->mine_block(data, this->node_address, meta_data);
+        else block = chain->mine_block_concurrently(data, this->node_address, meta_data, threads);
+    }
 
     return true;
 }
@@ -100,61 +95,84 @@ vector<string> Node::read_data_by_range(unsigned int range, Blockchain *chain)
     return content;
 }
 
-//! get_blocks_by_meta(string, Blockchain *)
+//! get_blocks_by_meta(string, Blockchain *, uint64_t, uint64_t, bool)
 /*! Parameters: 
 
 meta: A metadata string
 chain: A Blockchain object
-
-Get a list of Blocks which share a common metadata attribute.*/
-vector<Block *> Node::get_blocks_by_meta(string meta, Blockchain *chain)
+offset (optional): The number of matching blocks to be skipped.
+limit (optional): The maximum number of blocks to be returned.
+reverse (optional): If true, the newest blocks come first.
+
+Get a list of Blocks which share a common metadata attribute, ordered by block ID.
+If the ledger does not contain any such Block, an out_of_range exception is thrown.*/
+vector<Block *> Node::get_blocks_by_meta(string meta, Blockchain *chain, uint64_t offset = 0,
+                                         uint64_t limit = (uint64_t) -1, bool reverse = false)
 {
-    // Get all blocks in ledger, ordered by block ID:
-    vector<Block *> blocks = chain->get_blocks_by_range(chain->get_ledger_size());
-    vector<Block *> content;
-
-    // Search blocks retrieved above for the supplied metadata tag:
-    for(unsigned int i = 0; i < blocks.size(); i++)
-    {
-        if(blocks[i]->get_meta_data() == meta)
-            content.push_back(blocks[i]);
-    }
-
-    // If no Blocks were found, throw exception:
-    if(content.empty())
+    // If no Blocks carry the tag, throw exception:
+    if(!chain->count_blocks_by_meta(meta))
         throw out_of_range("Ledger does not contain block with meta tag " + meta);
 
-    return content;
+    return chain->get_blocks_by_meta(meta, offset, limit, reverse);
 }
 
-//! read_data_by_meta(string, Blockchain *)
+//! read_data_by_meta(string, Blockchain *, uint64_t, uint64_t, bool)
 /*! Parameters: 
 
 meta: A metadata string
 chain: A Blockchain object
-
-Get the data from all Block objects which share a common metadata attribute.*/
-vector<string> Node::read_data_by_meta(string meta, Blockchain *chain)
+offset (optional): The number of matching blocks to be skipped.
+limit (optional): The maximum number of blocks to be read.
+reverse (optional): If true, the newest blocks come first.
+
+Get the data from all Block objects which share a common metadata attribute, ordered by block ID.
+If the ledger does not contain any such Block, an out_of_range exception is thrown.*/
+vector<string> Node::read_data_by_meta(string meta, Blockchain *chain, uint64_t offset = 0,
+                                       uint64_t limit = (uint64_t) -1, bool reverse = false)
 {
-    // Get all blocks in ledger, ordered by block ID:
-    vector<Block *> blocks = chain->get_blocks_by_range(chain->get_ledger_size());
+    vector<Block *> blocks = this->get_blocks_by_meta(meta, chain, offset, limit, reverse);
     vector<string> content;
 
-    // Search blocks retrieved above for the supplied 
-    // metadata tag and save their content:
     for(unsigned int i = 0; i < blocks.size(); i++)
-    {
-        if(blocks[i]->get_meta_data() == meta)
-            content.push_back(blocks[i]->get_data());
-    }
-
-    // If no Blocks were found, throw exception:
-    if(content.empty())
-        throw out_of_range("Ledger does not contain block with meta tag " + meta);
+        content.push_back(blocks[i]->get_data());
 
     return content;
 }
 
+//! get_own_blocks(Blockchain *, uint64_t, uint64_t, bool)
+/*! Parameters: 
+
+chain: A Blockchain object
+offset (optional): The number of blocks to be skipped.
+limit (optional): The maximum number of blocks to be returned.
+reverse (optional): If true, the newest blocks come first.
+
+Get the Blocks mined by this Node object, i.e. the blocks it has written, ordered by block ID.*/
+vector<Block *> Node::get_own_blocks(Blockchain *chain, uint64_t offset = 0,
+                                     uint64_t limit = (uint64_t) -1, bool reverse = false)
+{ return chain->get_blocks_by_node(this->node_address, offset, limit, reverse); }
+
+//! count_own_blocks(Blockchain *)
+/*! Parameters: A Blockchain object
+Get the number of Blocks mined by this Node object.*/
+long unsigned int Node::count_own_blocks(Blockchain *chain)
+{ return chain->count_blocks_by_node(this->node_address); }
+
+//! get_blocks_by_time(uint64_t, uint64_t, Blockchain *, uint64_t, uint64_t, bool)
+/*! Parameters:
+
+start: The earliest UNIX timestamp in milliseconds to be matched.
+end: The UNIX timestamp in milliseconds after the latest one to be matched.
+chain: A Blockchain object
+offset (optional): The number of matching blocks to be skipped.
+limit (optional): The maximum number of blocks to be returned.
+reverse (optional): If true, the newest blocks come first.
+
+Get the Blocks written within a time window, ordered by block ID. An empty window is not an error.*/
+vector<Block *> Node::get_blocks_by_time(uint64_t start, uint64_t end, Blockchain *chain, uint64_t offset = 0,
+                                         uint64_t limit = (uint64_t) -1, bool reverse = false)
+{ return chain->get_blocks_by_time(start, end, offset, limit, reverse); }
+
 //! get_block_by_index(unsigned int, Blockchain *)
 /*! Parameters: 
 
@@ -164,12 +182,7 @@ chain: A Blockchain object
 Get the Block object at the specified index in the ledger.*/
 Block *Node::get_block_by_index(unsigned int index, Blockchain *chain)
 {
-    if(index > chain->get_ledger_size())
-        throw out_of_range("Requested index exceeds size of ledger.");
-
-    vector<Block *> blocks = chain->get_blocks_by_range(chain->get_ledger_size());
-
-    return blocks[index];
+    return chain->get_block_by_index(index);
 }
 
 //! Get the address (i.e. the SHA256 hash) of the Node object
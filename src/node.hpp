@@ -34,8 +34,6 @@ class Node {
         std::string node_name;
         std::string node_address;
 
-        int tries;
-
     protected:
     public:
 
@@ -48,9 +46,15 @@ class Node {
         void set_node_address(std::string node_address);
 
         std::vector<std::string> read_data_by_range(unsigned int range, Blockchain *chain);
-        std::vector<std::string> read_data_by_meta(std::string meta, Blockchain *chain);
+        std::vector<std::string> read_data_by_meta(std::string meta, Blockchain *chain, uint64_t offset,
+                                                   uint64_t limit, bool reverse);
         Block *get_block_by_index(unsigned int index, Blockchain *chain);
-        std::vector<Block *> get_blocks_by_meta(std::string meta, Blockchain *chain);
+        std::vector<Block *> get_blocks_by_meta(std::string meta, Blockchain *chain, uint64_t offset,
+                                                uint64_t limit, bool reverse);
+        std::vector<Block *> get_own_blocks(Blockchain *chain, uint64_t offset, uint64_t limit, bool reverse);
+        long unsigned int count_own_blocks(Blockchain *chain);
+        std::vector<Block *> get_blocks_by_time(uint64_t start, uint64_t end, Blockchain *chain, uint64_t offset,
+                                                uint64_t limit, bool reverse);
         bool write_data(std::string data, Blockchain *chain, int try_limit, 
                         std::string meta_data, unsigned int threads);
 };
@@ -0,0 +1,79 @@
+// Copyright 2020 Falk Spickenbaum
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NONCE_SCHEDULER_HEADER
+#define NONCE_SCHEDULER_HEADER
+#include "nonce_scheduler.hpp"
+#endif
+
+#include <algorithm>
+
+//! Construct a NonceScheduler object
+/*! Parameters:
+
+first_nonce: The first nonce of the attempt.
+limit: The number of nonces to be handed out in total, i.e. the try limit.
+workers: The number of workers taking part.
+chunk_size: The number of nonces handed out at once.*/
+NonceScheduler::NonceScheduler(uint64_t first_nonce, uint64_t limit, unsigned int workers,
+                               uint64_t chunk_size = NONCE_CHUNK_SIZE)
+    : handed_out(0), coverage(workers)
+{
+    this->first_nonce = first_nonce;
+    this->limit = limit;
+    this->chunk_size = chunk_size ? chunk_size : 1;
+
+    for(unsigned int i = 0; i < workers; i++)
+    {
+        this->coverage[i].worker = i;
+        this->coverage[i].hashes = 0;
+    }
+}
+
+//! next_chunk(uint64_t &, uint64_t &)
+/*! Parameters: The bounds of the chunk to be written.
+Hands out the next chunk [first, last). Chunks never overlap.
+Returns false once all nonces of the attempt have been handed out.*/
+bool NonceScheduler::next_chunk(uint64_t &first, uint64_t &last)
+{
+    uint64_t offset = this->handed_out.fetch_add(this->chunk_size);
+
+    if(offset >= this->limit) return false;
+
+    first = this->first_nonce + offset;
+    last = this->first_nonce + std::min(offset + this->chunk_size, this->limit);
+    return true;
+}
+
+//! record(unsigned int, uint64_t, uint64_t)
+/*! Parameters: The index of a worker and the range [first, last) it has hashed.
+Only the worker itself may record its coverage, so no locking is needed.*/
+void NonceScheduler::record(unsigned int worker, uint64_t first, uint64_t last)
+{
+    if(first == last) return;
+
+    WorkerCoverage &entry = this->coverage[worker];
+    entry.hashes += last - first;
+
+    // Merge with the previous range if the worker got two consecutive chunks:
+    if(!entry.ranges.empty() && entry.ranges.back().second == first)
+        entry.ranges.back().second = last;
+    else
+        entry.ranges.push_back(std::make_pair(first, last));
+}
+
+//! get_coverage(void)
+/*! Returns the coverage of every worker. Only to be called after all workers have returned.*/
+std::vector<WorkerCoverage> NonceScheduler::get_coverage()
+{ return this->coverage; }
@@ -0,0 +1,61 @@
+// Copyright 2020 Falk Spickenbaum
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NONCE_SCHEDULER_HPP
+#define NONCE_SCHEDULER_HPP
+
+#include <atomic>
+#include <utility>
+#include <vector>
+#include <stdint.h>
+
+// Number of nonces handed to a worker at once. A multiple of every engine's lane count:
+#define NONCE_CHUNK_SIZE 4096
+
+//! WorkerCoverage
+/*! The nonces a single worker has hashed during a mining attempt, as half-open ranges [first, second).*/
+struct WorkerCoverage {
+
+    unsigned int worker;
+    uint64_t hashes;
+    std::vector<std::pair<uint64_t, uint64_t>> ranges;
+};
+
+//! NonceScheduler
+/*! Splits the nonces of a mining attempt into chunks and hands each chunk to exactly one worker.
+Workers ask for the next chunk once they are done with their current one, so fast workers
+simply take more chunks. Each worker records what it has covered in its own WorkerCoverage entry.*/
+class NonceScheduler {
+
+    private:
+
+        uint64_t first_nonce;
+        uint64_t limit;
+        uint64_t chunk_size;
+        std::atomic<uint64_t> handed_out;
+        std::vector<WorkerCoverage> coverage;
+
+    protected:
+    public:
+
+        NonceScheduler(uint64_t first_nonce, uint64_t limit, unsigned int workers,
+                       uint64_t chunk_size);
+
+        bool next_chunk(uint64_t &first, uint64_t &last);
+        void record(unsigned int worker, uint64_t first, uint64_t last);
+
+        std::vector<WorkerCoverage> get_coverage();
+};
+
+#endif
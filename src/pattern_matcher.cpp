@@ -0,0 +1,66 @@
+// Copyright 2020 Falk Spickenbaum
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef PATTERN_MATCHER_HEADER
+#define PATTERN_MATCHER_HEADER
+#include "pattern_matcher.hpp"
+#endif
+
+#include <cstring>
+
+//! Construct a PatternMatcher object
+/*! Parameters: The bytes to be found. An empty pattern is found in every buffer.*/
+PatternMatcher::PatternMatcher(const std::string &pattern)
+{
+    this->pattern = pattern;
+}
+
+//! match(const char *, uint64_t)
+/*! Parameters: A buffer and its size in bytes.
+Returns true if the pattern occurs within the buffer.*/
+bool PatternMatcher::match(const char *data, uint64_t size) const
+{
+    const char *needle = this->pattern.data();
+    uint64_t length = this->pattern.size();
+
+    if(length > size) return false;
+    if(length == 0) return true;
+    if(length == 1) return memchr(data, needle[0], size) != NULL;
+
+    uint64_t i = 0;
+
+#ifdef __SSE2__
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[length - 1]);
+
+    // Test the positions i to i + 15 as long as the last byte of each lies within the buffer:
+    for(; i + length + 15 <= size; i += 16)
+    {
+        __m128i block_first = _mm_loadu_si128((const __m128i *) (data + i));
+        __m128i block_last = _mm_loadu_si128((const __m128i *) (data + i + length - 1));
+        uint32_t mask = (uint32_t) _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(block_first, first),
+                                                                   _mm_cmpeq_epi8(block_last, last)));
+
+        for(; mask; mask &= mask - 1)
+            if(!memcmp(data + i + __builtin_ctz(mask) + 1, needle + 1, length - 2)) return true;
+    }
+#endif
+
+    for(; i + length <= size; i++)
+        if(data[i] == needle[0] && data[i + length - 1] == needle[length - 1] &&
+           !memcmp(data + i + 1, needle + 1, length - 2)) return true;
+
+    return false;
+}
@@ -0,0 +1,45 @@
+// Copyright 2020 Falk Spickenbaum
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef PATTERN_MATCHER_HPP
+#define PATTERN_MATCHER_HPP
+
+#include <string>
+#include <stdint.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+//! PatternMatcher
+/*! Finds a fixed string of bytes within a buffer. With SSE2, 16 positions are tested at once by
+comparing the bytes of the buffer against the first and the last byte of the pattern; only the
+positions where both match are compared in full. Single bytes are found through memchr. A matcher
+holds a copy of the pattern and may be shared between threads.*/
+class PatternMatcher {
+
+    private:
+
+        std::string pattern;
+
+    protected:
+    public:
+
+        PatternMatcher(const std::string &pattern);
+
+        bool match(const char *data, uint64_t size) const;
+};
+
+#endif
@@ -19,60 +19,95 @@
 
 #include <string>
 
-/*  Simple hashcash implementation. */
+/*  Simple hashcash implementation.
 
-//! find_trailing_zero(string)
-/*! Parameters: A SHA hash to be examined for trailing zeros
-This function finds the number of trailing zeros in any given SHA hash.*/
-int find_trailing_zeros(std::string hash)
-{
-    unsigned short int i = 0;
+    A hash satisfies a difficulty d if its binary notation starts with at least d zeros.
+    The check works on the raw digest, one 64 bit word at a time. The string based functions
+    below are kept for Python and return results consistent with it. */
 
-    // Count the number of uninterrupted zeros in the given hash:
-    while((hash[i++] == '0') && (i != (unsigned int)hash.size() - 1));
+//! count_leading_zero_bits(Hash256)
+/*! Parameters: A raw SHA hash.
+Returns the number of leading zero bits of the hash, between 0 and 256.*/
+inline unsigned int count_leading_zero_bits(const Hash256 &hash)
+{
+    for(int i = 0; i < 4; i++)
+    {
+        uint64_t word = hash.word(i);
+        if(word) return 64 * i + __builtin_clzll(word);
+    }
 
-    return i;
+    return 256;
 }
 
-const std::string hex_to_bin(char c)
-{
-    switch(toupper(c))
+//! PowTarget
+/*! A difficulty prepared for checking many candidate hashes.
+The first 32 bit word of a SHA256 digest alone is enough to reject almost every candidate, so the
+mining loop inspects it via may_satisfy before the remaining words are looked at.*/
+struct PowTarget {
+
+    long unsigned int difficulty;
+    uint32_t first_word_max;
+
+    PowTarget(long unsigned int difficulty)
     {
-        case '0': return "0000";
-        case '1': return "0001";
-        case '2': return "0010";
-        case '3': return "0011";
-        case '4': return "0100";
-        case '5': return "0101";
-        case '6': return "0110";
-        case '7': return "0111";
-        case '8': return "1000";
-        case '9': return "1001";
-        case 'A': return "1010";
-        case 'B': return "1011";
-        case 'C': return "1100";
-        case 'D': return "1101";
-        case 'E': return "1110";
-        case 'F': return "1111";
-        default: return "0";
+        this->difficulty = difficulty;
+
+        // The largest first word which can still be followed by enough zeros:
+        if(difficulty >= 32) this->first_word_max = 0;
+        else this->first_word_max = 0xffffffffu >> difficulty;
     }
+
+    //! Early reject: false if a hash starting with this word cannot satisfy the difficulty.
+    bool may_satisfy(uint32_t first_word) const
+    { return first_word <= this->first_word_max; }
+
+    //! Full check on a raw hash.
+    bool is_satisfied(const Hash256 &hash) const
+    { return count_leading_zero_bits(hash) >= this->difficulty; }
+};
+
+//! find_trailing_zero(string)
+/*! Parameters: A SHA hash in binary notation, as returned by convert_to_bin.
+This function finds the number of uninterrupted zeros at the start of a given SHA hash.*/
+int find_trailing_zeros(std::string hash)
+{
+    size_t zeros = hash.find_first_not_of('0');
+    return (int) ((zeros == std::string::npos) ? hash.size() : zeros);
 }
 
 //! convert_to_bin(string)
 /*! Parameters: A SHA hash in hexadecimal notation.
 This function converts a hash in hexadecimal notation into binary 
-notation and returns it as a string.*/
+notation and returns it as a string. Characters which are not hexadecimal are converted to "0".*/
 std::string convert_to_bin(std::string hash)
 {
     std::string binary;
+    binary.reserve(hash.size() * 4);
 
     // Assemble binary string:
     for(int i = 0; i < (int) hash.size(); i++)
-        binary += hex_to_bin(hash[i]);
+    {
+        char c = hash[i];
+        int value = (c >= '0' && c <= '9') ? c - '0' :
+                    (c >= 'a' && c <= 'f') ? c - 'a' + 10 :
+                    (c >= 'A' && c <= 'F') ? c - 'A' + 10 : -1;
+
+        if(value < 0) { binary += '0'; continue; }
+
+        for(int bit = 3; bit >= 0; bit--) binary += (value >> bit & 1) ? '1' : '0';
+    }
 
     return binary;
 }
 
+//! hash_meets_difficulty(Hash256, long unsigned int)
+/*! Parameters: A raw SHA hash and a difficulty.
+Returns true if the hash satisfies the given difficulty, else it returns false.*/
+bool hash_meets_difficulty(const Hash256 &hash, long unsigned int difficulty)
+{
+    return count_leading_zero_bits(hash) >= difficulty;
+}
+
 //! run_hash_cash(Block *)
 /*! Parameters: A Block object.
 Runs the hashcash proof-of-work algorithm on a given block.
@@ -80,16 +115,7 @@ Returns true if the block hash satisfies the difficulty contained within the blo
 else it returns false.*/
 bool run_hash_cash(Block *block)
 {
-    std::string hash = convert_to_bin(block->get_block_hash());
-    long unsigned int difficulty = block->get_difficulty();
-
-    unsigned short int zeros;
-
-    // Check if block hash satisfies the current difficulty:
-    if((zeros = find_trailing_zeros(hash)) >= difficulty)
-        return true;
-
-    return false;
+    return hash_meets_difficulty(block->get_block_hash(), block->get_difficulty());
 }
 
 //! verify_attempt(Block *)
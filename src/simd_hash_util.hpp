@@ -0,0 +1,761 @@
+// Copyright 2020 Falk Spickenbaum
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SIMDHASHUTIL_HPP
+#define SIMDHASHUTIL_HPP
+
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "PicoSHA2/picosha2.h"
+#include "hash256.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define SWIFTCHAIN_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+/*  Multi-buffer SHA256.
+
+    The kernels below compress 4 (SSE4.1), 8 (AVX2) or 16 (AVX-512) independent 64 byte blocks at once.
+    Each SIMD lane holds one message, so the state is stored interleaved (state[word][lane]).
+    A further kernel uses the SHA extensions (SHA-NI) to compress a single block.
+    They are compiled with function-level target attributes, which means that the library itself
+    can still be built for generic x86-64 and only calls a kernel once the CPU is known to support it.
+    PicoSHA2 remains the scalar reference implementation. */
+
+#define SHA256_MAX_LANES 16
+
+static const uint32_t sha256_round_constants[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+    0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+    0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+    0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+    0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+static const uint32_t sha256_initial_state[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+    0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+
+//! load_be32(const unsigned char *)
+/*! Read a big-endian 32 bit word from a byte buffer.*/
+inline uint32_t load_be32(const unsigned char *p)
+{
+    return ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16) |
+           ((uint32_t) p[2] << 8) | (uint32_t) p[3];
+}
+
+//! store_be32(unsigned char *, uint32_t)
+/*! Write a 32 bit word into a byte buffer in big-endian order.*/
+inline void store_be32(unsigned char *p, uint32_t x)
+{
+    p[0] = (unsigned char) (x >> 24); p[1] = (unsigned char) (x >> 16);
+    p[2] = (unsigned char) (x >> 8);  p[3] = (unsigned char) x;
+}
+
+#ifdef SWIFTCHAIN_X86_SIMD
+
+#define SHA256_MB_ROUNDS(V, LOAD, ADD, XOR, AND, OR, ANDNOT, SRL, SLL, SET1)                 \
+    V w[16];                                                                                  \
+    V a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];         \
+    for(int i = 0; i < 64; i++)                                                              \
+    {                                                                                         \
+        if(i >= 16)                                                                           \
+        {                                                                                     \
+            V w15 = w[(i - 15) & 15], w2 = w[(i - 2) & 15];                                   \
+            V s0 = XOR(XOR(OR(SRL(w15, 7), SLL(w15, 25)), OR(SRL(w15, 18), SLL(w15, 14))),    \
+                       SRL(w15, 3));                                                          \
+            V s1 = XOR(XOR(OR(SRL(w2, 17), SLL(w2, 15)), OR(SRL(w2, 19), SLL(w2, 13))),       \
+                       SRL(w2, 10));                                                          \
+            w[i & 15] = ADD(ADD(w[i & 15], s0), ADD(w[(i - 7) & 15], s1));                    \
+        }                                                                                     \
+        else w[i] = LOAD(blocks, i);                                                          \
+                                                                                              \
+        V S1 = XOR(XOR(OR(SRL(e, 6), SLL(e, 26)), OR(SRL(e, 11), SLL(e, 21))),                \
+                   OR(SRL(e, 25), SLL(e, 7)));                                                \
+        V ch = XOR(AND(e, f), ANDNOT(e, g));                                                  \
+        V t1 = ADD(ADD(ADD(h, S1), ADD(ch, SET1((int) sha256_round_constants[i]))), w[i & 15]);\
+        V S0 = XOR(XOR(OR(SRL(a, 2), SLL(a, 30)), OR(SRL(a, 13), SLL(a, 19))),                \
+                   OR(SRL(a, 22), SLL(a, 10)));                                               \
+        V maj = XOR(XOR(AND(a, b), AND(a, c)), AND(b, c));                                    \
+        V t2 = ADD(S0, maj);                                                                  \
+        h = g; g = f; f = e; e = ADD(d, t1);                                                  \
+        d = c; c = b; b = a; a = ADD(t1, t2);                                                 \
+    }                                                                                         \
+    s[0] = ADD(s[0], a); s[1] = ADD(s[1], b); s[2] = ADD(s[2], c); s[3] = ADD(s[3], d);       \
+    s[4] = ADD(s[4], e); s[5] = ADD(s[5], f); s[6] = ADD(s[6], g); s[7] = ADD(s[7], h);
+
+__attribute__((target("sse4.1")))
+inline __m128i load_words_x4(const unsigned char *const *blocks, int i)
+{
+    return _mm_set_epi32((int) load_be32(blocks[3] + 4 * i), (int) load_be32(blocks[2] + 4 * i),
+                         (int) load_be32(blocks[1] + 4 * i), (int) load_be32(blocks[0] + 4 * i));
+}
+
+//! sha256_compress_x4(uint32_t[8][8], const unsigned char *const *)
+/*! Parameters: An interleaved state and one 64 byte block for each of the first 4 lanes.
+Compresses 4 blocks at once using SSE4.1 instructions.*/
+__attribute__((target("sse4.1")))
+inline void sha256_compress_x4(uint32_t state[8][SHA256_MAX_LANES], const unsigned char *const *blocks)
+{
+    __m128i s[8];
+    for(int i = 0; i < 8; i++) s[i] = _mm_loadu_si128((const __m128i *) state[i]);
+
+    SHA256_MB_ROUNDS(__m128i, load_words_x4, _mm_add_epi32, _mm_xor_si128, _mm_and_si128,
+                     _mm_or_si128, _mm_andnot_si128, _mm_srli_epi32, _mm_slli_epi32, _mm_set1_epi32)
+
+    for(int i = 0; i < 8; i++) _mm_storeu_si128((__m128i *) state[i], s[i]);
+}
+
+__attribute__((target("avx2")))
+inline __m256i load_words_x8(const unsigned char *const *blocks, int i)
+{
+    return _mm256_set_epi32((int) load_be32(blocks[7] + 4 * i), (int) load_be32(blocks[6] + 4 * i),
+                            (int) load_be32(blocks[5] + 4 * i), (int) load_be32(blocks[4] + 4 * i),
+                            (int) load_be32(blocks[3] + 4 * i), (int) load_be32(blocks[2] + 4 * i),
+                            (int) load_be32(blocks[1] + 4 * i), (int) load_be32(blocks[0] + 4 * i));
+}
+
+//! sha256_compress_x8(uint32_t[8][8], const unsigned char *const *)
+/*! Parameters: An interleaved state of 8 lanes and one 64 byte block per lane.
+Compresses 8 blocks at once using AVX2 instructions.*/
+__attribute__((target("avx2")))
+inline void sha256_compress_x8(uint32_t state[8][SHA256_MAX_LANES], const unsigned char *const *blocks)
+{
+    __m256i s[8];
+    for(int i = 0; i < 8; i++) s[i] = _mm256_loadu_si256((const __m256i *) state[i]);
+
+    SHA256_MB_ROUNDS(__m256i, load_words_x8, _mm256_add_epi32, _mm256_xor_si256, _mm256_and_si256,
+                     _mm256_or_si256, _mm256_andnot_si256, _mm256_srli_epi32, _mm256_slli_epi32,
+                     _mm256_set1_epi32)
+
+    for(int i = 0; i < 8; i++) _mm256_storeu_si256((__m256i *) state[i], s[i]);
+}
+
+// The AVX-512 shift intrinsics of GCC start from an undefined register, which trips its own warnings:
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+__attribute__((target("avx512f")))
+inline __m512i load_words_x16(const unsigned char *const *blocks, int i)
+{
+    return _mm512_set_epi32((int) load_be32(blocks[15] + 4 * i), (int) load_be32(blocks[14] + 4 * i),
+                            (int) load_be32(blocks[13] + 4 * i), (int) load_be32(blocks[12] + 4 * i),
+                            (int) load_be32(blocks[11] + 4 * i), (int) load_be32(blocks[10] + 4 * i),
+                            (int) load_be32(blocks[9] + 4 * i), (int) load_be32(blocks[8] + 4 * i),
+                            (int) load_be32(blocks[7] + 4 * i), (int) load_be32(blocks[6] + 4 * i),
+                            (int) load_be32(blocks[5] + 4 * i), (int) load_be32(blocks[4] + 4 * i),
+                            (int) load_be32(blocks[3] + 4 * i), (int) load_be32(blocks[2] + 4 * i),
+                            (int) load_be32(blocks[1] + 4 * i), (int) load_be32(blocks[0] + 4 * i));
+}
+
+//! sha256_compress_x16(uint32_t[8][16], const unsigned char *const *)
+/*! Parameters: An interleaved state of 16 lanes and one 64 byte block per lane.
+Compresses 16 blocks at once using AVX-512 instructions.*/
+__attribute__((target("avx512f")))
+inline void sha256_compress_x16(uint32_t state[8][SHA256_MAX_LANES], const unsigned char *const *blocks)
+{
+    __m512i s[8];
+    for(int i = 0; i < 8; i++) s[i] = _mm512_loadu_si512((const void *) state[i]);
+
+    SHA256_MB_ROUNDS(__m512i, load_words_x16, _mm512_add_epi32, _mm512_xor_si512, _mm512_and_si512,
+                     _mm512_or_si512, _mm512_andnot_si512, _mm512_srli_epi32, _mm512_slli_epi32,
+                     _mm512_set1_epi32)
+
+    for(int i = 0; i < 8; i++) _mm512_storeu_si512((void *) state[i], s[i]);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#undef SHA256_MB_ROUNDS
+
+//! sha256_compress_shani(uint32_t[8], const unsigned char *)
+/*! Parameters: A single SHA256 state and a 64 byte block.
+Compresses one block using the SHA extensions. The instructions operate on the state
+in the order ABEF/CDGH, four rounds per loop iteration.*/
+__attribute__((target("sha,sse4.1")))
+inline void sha256_compress_shani(uint32_t state[8], const unsigned char *block)
+{
+    const __m128i byte_swap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    __m128i msg[4];
+
+    __m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *) &state[0]), 0xb1);
+    __m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *) &state[4]), 0x1b);
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);
+    state1 = _mm_blend_epi16(state1, tmp, 0xf0);
+
+    __m128i abef = state0, cdgh = state1;
+
+    for(int i = 0; i < 16; i++)
+    {
+        if(i < 4)
+            msg[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (block + 16 * i)), byte_swap);
+        else
+            msg[i & 3] = _mm_sha256msg2_epu32(
+                _mm_add_epi32(_mm_sha256msg1_epu32(msg[i & 3], msg[(i + 1) & 3]),
+                              _mm_alignr_epi8(msg[(i + 3) & 3], msg[(i + 2) & 3], 4)),
+                msg[(i + 3) & 3]);
+
+        __m128i k = _mm_add_epi32(msg[i & 3],
+                                  _mm_loadu_si128((const __m128i *) &sha256_round_constants[4 * i]));
+        state1 = _mm_sha256rnds2_epu32(state1, state0, k);
+        state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(k, 0x0e));
+    }
+
+    state0 = _mm_add_epi32(state0, abef);
+    state1 = _mm_add_epi32(state1, cdgh);
+
+    tmp = _mm_shuffle_epi32(state0, 0x1b);
+    state1 = _mm_shuffle_epi32(state1, 0xb1);
+    _mm_storeu_si128((__m128i *) &state[0], _mm_blend_epi16(tmp, state1, 0xf0));
+    _mm_storeu_si128((__m128i *) &state[4], _mm_alignr_epi8(state1, tmp, 8));
+}
+
+#endif
+
+//! sha256_compress_x1(uint32_t[8], const unsigned char *)
+/*! Parameters: A single SHA256 state and a 64 byte block.
+Compresses one block using the scalar PicoSHA2 implementation.*/
+inline void sha256_compress_x1(uint32_t state[8], const unsigned char *block)
+{
+    picosha2::word_t digest[8];
+
+    for(int i = 0; i < 8; i++) digest[i] = state[i];
+    picosha2::detail::hash256_block(digest, block, block + 64);
+    for(int i = 0; i < 8; i++) state[i] = (uint32_t) digest[i];
+}
+
+/*  Hash engines.
+
+    Each engine bundles a kernel that compresses one block per lane with a kernel for single
+    messages. The engine in use is picked once the module is loaded: every engine the CPU supports
+    hashes a short run of nonces and the fastest one is kept, since which kernel wins differs
+    between CPU generations. It can be forced through the SWIFTCHAIN_HASH_ENGINE environment
+    variable or set_hash_engine(string), e.g. to compare hash rates.
+    "picosha2" is available everywhere. */
+
+#define SHA256_ENGINE_COUNT 5
+
+typedef void (*sha256_lanes_kernel)(uint32_t state[8][SHA256_MAX_LANES], const unsigned char *const *blocks);
+typedef void (*sha256_single_kernel)(uint32_t state[8], const unsigned char *block);
+
+//! HashEngine
+/*! A SHA256 implementation, as listed by sha256_engines.*/
+struct HashEngine {
+
+    const char *name;
+    const char *cpu_feature;
+    unsigned int lanes;
+    sha256_lanes_kernel compress;
+    sha256_single_kernel compress_one;
+
+    //! Returns true if the CPU this process runs on can execute the engine.
+    bool is_supported() const
+    {
+        if(!this->cpu_feature) return true;
+#ifdef SWIFTCHAIN_X86_SIMD
+        __builtin_cpu_init();
+        if(!strcmp(this->cpu_feature, "sha"))
+        {
+            // __builtin_cpu_supports does not know the SHA extensions on every compiler:
+            unsigned int eax, ebx, ecx, edx;
+            __asm__("cpuid" : "=a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx) : "a"(7), "c"(0));
+            return (ebx >> 29 & 1) && __builtin_cpu_supports("sse4.1");
+        }
+        if(!strcmp(this->cpu_feature, "avx512f")) return __builtin_cpu_supports("avx512f");
+        if(!strcmp(this->cpu_feature, "avx2")) return __builtin_cpu_supports("avx2");
+        if(!strcmp(this->cpu_feature, "sse4.1")) return __builtin_cpu_supports("sse4.1");
+#endif
+        return false;
+    }
+};
+
+//! Compress each lane on its own, using the single message kernel of the engine.
+template <sha256_single_kernel kernel, unsigned int lanes>
+inline void sha256_compress_serial(uint32_t state[8][SHA256_MAX_LANES], const unsigned char *const *blocks)
+{
+    for(unsigned int l = 0; l < lanes; l++)
+    {
+        uint32_t single[8];
+
+        for(int w = 0; w < 8; w++) single[w] = state[w][l];
+        kernel(single, blocks[l]);
+        for(int w = 0; w < 8; w++) state[w][l] = single[w];
+    }
+}
+
+//! sha256_engines(void)
+/*! Returns the list of all engines, SHA256_ENGINE_COUNT in total.
+The SHA-NI engine hashes four nonces per batch one after the other, which keeps the mining
+loop overhead per nonce comparable to the multi-buffer engines.*/
+inline const HashEngine *sha256_engines()
+{
+    static const HashEngine engines[SHA256_ENGINE_COUNT] = {
+#ifdef SWIFTCHAIN_X86_SIMD
+        {"sha-ni", "sha", 4, sha256_compress_serial<sha256_compress_shani, 4>, sha256_compress_shani},
+        {"avx512", "avx512f", 16, sha256_compress_x16, sha256_compress_x1},
+        {"avx2", "avx2", 8, sha256_compress_x8, sha256_compress_x1},
+        {"sse4.1", "sse4.1", 4, sha256_compress_x4, sha256_compress_x1},
+#else
+        {"sha-ni", "sha", 4, NULL, NULL},
+        {"avx512", "avx512f", 16, NULL, NULL},
+        {"avx2", "avx2", 8, NULL, NULL},
+        {"sse4.1", "sse4.1", 4, NULL, NULL},
+#endif
+        {"picosha2", NULL, 1, sha256_compress_serial<sha256_compress_x1, 1>, sha256_compress_x1}};
+
+    return engines;
+}
+
+//! fastest_hash_engine(void)
+/*! Returns the supported engine which hashes a run of 4096 header-sized messages the fastest.
+The measurement is taken once per process.*/
+inline const HashEngine *fastest_hash_engine()
+{
+    static const HashEngine *fastest = NULL;
+    if(fastest) return fastest;
+
+    const HashEngine *engines = sha256_engines(), *best = NULL;
+    double best_time = 0;
+
+    for(int i = 0; i < SHA256_ENGINE_COUNT; i++)
+    {
+        if(!engines[i].is_supported()) continue;
+
+        uint32_t state[8][SHA256_MAX_LANES] = {};
+        unsigned char buffer[SHA256_MAX_LANES][64] = {};
+        const unsigned char *blocks[SHA256_MAX_LANES];
+
+        for(unsigned int l = 0; l < SHA256_MAX_LANES; l++) blocks[l] = buffer[l];
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for(unsigned int n = 0; n < 4096; n += engines[i].lanes)
+        {
+            buffer[0][0] = (unsigned char) n;
+            engines[i].compress(state, blocks);
+        }
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        // Keep the result alive:
+        if(state[0][0] == 0x12345678) elapsed += 1e-9;
+
+        if(!best || elapsed < best_time) { best = &engines[i]; best_time = elapsed; }
+    }
+
+    return fastest = best;
+}
+
+//! find_hash_engine(string)
+/*! Parameters: The name of an engine, or "auto" for the fastest engine the CPU supports.
+Returns the engine. Throws an invalid_argument exception if the engine is unknown
+or not supported by this CPU.*/
+inline const HashEngine *find_hash_engine(const std::string &name)
+{
+    const HashEngine *engines = sha256_engines();
+
+    if(name == "auto") return fastest_hash_engine();
+
+    for(int i = 0; i < SHA256_ENGINE_COUNT; i++)
+    {
+        if(name != engines[i].name) continue;
+
+        if(!engines[i].is_supported())
+            throw std::invalid_argument("Hash engine " + name + " is not supported by this CPU.");
+        return &engines[i];
+    }
+
+    throw std::invalid_argument("Unknown hash engine " + name);
+}
+
+//! Holds the engine in use. It is read once per mining attempt, so it may be changed at any time.
+inline std::atomic<const HashEngine *> &active_hash_engine()
+{
+    static std::atomic<const HashEngine *> engine(NULL);
+    return engine;
+}
+
+//! sha256_engine(void)
+/*! Returns the engine in use. On the first call, the engine named by the SWIFTCHAIN_HASH_ENGINE
+environment variable is selected. If it is not set or cannot be used, the fastest engine is selected.*/
+inline const HashEngine &sha256_engine()
+{
+    const HashEngine *engine = active_hash_engine().load();
+    if(engine) return *engine;
+
+    const char *forced = getenv("SWIFTCHAIN_HASH_ENGINE");
+
+    try
+    { engine = find_hash_engine(forced ? forced : "auto"); }
+    catch(std::invalid_argument &ex)
+    {
+        std::cout << ex.what() << " Falling back to the fastest supported engine." << std::endl;
+        engine = find_hash_engine("auto");
+    }
+
+    const HashEngine *expected = NULL;
+    active_hash_engine().compare_exchange_strong(expected, engine);
+    return *active_hash_engine().load();
+}
+
+//! set_hash_engine(string)
+/*! Parameters: The name of an engine, or "auto".
+Forces the engine used for mining and verification. Throws an invalid_argument exception
+if the engine cannot be used on this CPU.*/
+inline void set_hash_engine(const std::string &name)
+{ active_hash_engine().store(find_hash_engine(name)); }
+
+//! get_hash_engine(void)
+/*! Returns the name of the engine in use.*/
+inline std::string get_hash_engine()
+{ return sha256_engine().name; }
+
+//! get_hash_engines(void)
+/*! Returns the names of all engines this CPU supports.*/
+inline std::vector<std::string> get_hash_engines()
+{
+    std::vector<std::string> names;
+    const HashEngine *engines = sha256_engines();
+
+    for(int i = 0; i < SHA256_ENGINE_COUNT; i++)
+        if(engines[i].is_supported()) names.push_back(engines[i].name);
+
+    return names;
+}
+
+//! sha256_compress_lanes(HashEngine, uint32_t[8][16], const unsigned char *const *, unsigned int)
+/*! Parameters: An engine, an interleaved state, one 64 byte block per lane and the number of lanes.
+Compresses the given blocks on the multi-buffer kernel if all lanes of the engine are used,
+else one by one.*/
+inline void sha256_compress_lanes(const HashEngine &engine, uint32_t state[8][SHA256_MAX_LANES],
+                                  const unsigned char *const *blocks, unsigned int lanes)
+{
+    if(lanes == engine.lanes) return engine.compress(state, blocks);
+
+    for(unsigned int l = 0; l < lanes; l++)
+    {
+        uint32_t single[8];
+
+        for(int w = 0; w < 8; w++) single[w] = state[w][l];
+        engine.compress_one(single, blocks[l]);
+        for(int w = 0; w < 8; w++) state[w][l] = single[w];
+    }
+}
+
+//! sha256_pad(string)
+/*! Parameters: A message to be hashed.
+Returns the message with the SHA256 padding and length appended.*/
+inline std::string sha256_pad(const std::string &msg)
+{
+    std::string padded(msg);
+    uint64_t bits = (uint64_t) msg.size() * 8;
+
+    padded += (char) 0x80;
+    padded.append((119 - msg.size() % 64) % 64, '\0');
+
+    for(int i = 7; i >= 0; i--) padded += (char) (bits >> (8 * i));
+
+    return padded;
+}
+
+//! sha256_hash_multi(const string *, unsigned int, Hash256 *)
+/*! Parameters:
+
+msgs: An array of messages of equal length.
+count: The number of messages, at most SHA256_MAX_LANES.
+digests: An array receiving one raw digest per message.
+
+engine (optional): The engine to be used.
+
+Hashes up to SHA256_MAX_LANES messages at once on the multi-buffer kernel of the engine.
+Messages of differing length are hashed one by one.*/
+inline void sha256_hash_multi(const std::string *msgs, unsigned int count, Hash256 *digests,
+                              const HashEngine &engine = sha256_engine())
+{
+    uint32_t state[8][SHA256_MAX_LANES];
+    const unsigned char *blocks[SHA256_MAX_LANES];
+    std::string padded[SHA256_MAX_LANES];
+
+    unsigned int lanes = engine.lanes;
+    bool same_length = true;
+
+    for(unsigned int i = 1; i < count; i++)
+        same_length = same_length && msgs[i].size() == msgs[0].size();
+
+    if(count > lanes || !same_length) lanes = 1;
+
+    for(unsigned int i = 0; i < count; i++) padded[i] = sha256_pad(msgs[i]);
+
+    // Unused lanes hash a copy of the first message:
+    for(unsigned int i = count; i < lanes; i++) padded[i] = padded[0];
+
+    for(unsigned int first = 0; first < count; first += lanes)
+    {
+        for(int w = 0; w < 8; w++)
+            for(unsigned int l = 0; l < lanes; l++) state[w][l] = sha256_initial_state[w];
+
+        for(size_t off = 0; off < padded[first].size(); off += 64)
+        {
+            for(unsigned int l = 0; l < lanes; l++)
+                blocks[l] = (const unsigned char *) padded[first + l].data() + off;
+
+            sha256_compress_lanes(engine, state, blocks, lanes);
+        }
+
+        for(unsigned int l = 0; l < lanes && first + l < count; l++)
+            for(int w = 0; w < 8; w++) store_be32(digests[first + l].bytes + 4 * w, state[w][l]);
+    }
+}
+
+//! sha256_hash(const unsigned char *, size_t, Hash256 &)
+/*! Parameters: A message, its length in bytes, a digest to be written and optionally an engine.
+Hashes a single message on the single message kernel of the engine.*/
+inline void sha256_hash(const unsigned char *msg, size_t size, Hash256 &digest,
+                        const HashEngine &engine = sha256_engine())
+{
+    uint32_t state[8];
+    unsigned char last[128];
+    size_t full = size - size % 64, rest = size - full;
+    size_t padded = (rest + 9 <= 64) ? 64 : 128;
+
+    for(int w = 0; w < 8; w++) state[w] = sha256_initial_state[w];
+    for(size_t off = 0; off < full; off += 64) engine.compress_one(state, msg + off);
+
+    memcpy(last, msg + full, rest);
+    last[rest] = 0x80;
+    memset(last + rest + 1, 0, padded - rest - 9);
+    store_be32(last + padded - 8, (uint32_t) (((uint64_t) size * 8) >> 32));
+    store_be32(last + padded - 4, (uint32_t) ((uint64_t) size * 8));
+
+    for(size_t off = 0; off < padded; off += 64) engine.compress_one(state, last + off);
+    for(int w = 0; w < 8; w++) store_be32(digest.bytes + 4 * w, state[w]);
+}
+
+//! Sha256NonceBuffer
+/*! The final one or two blocks of prefix || nonce for every lane, padded once by Sha256Midstate::prepare.
+Afterwards, only the nonce bytes are overwritten for each batch. Each mining worker owns one.*/
+struct Sha256NonceBuffer {
+
+    unsigned char blocks[SHA256_MAX_LANES][128];
+    size_t nonce_offset;
+    size_t size;
+};
+
+//! Sha256Midstate
+/*! Hashes messages of the form prefix || nonce, where nonce is a 64 bit big-endian counter.
+The compression state over all complete 64 byte blocks of the prefix is computed once on construction,
+so finishing a hash for another nonce costs one or two compressions regardless of the prefix length.
+A midstate keeps the engine it was constructed with.*/
+struct Sha256Midstate {
+
+    uint32_t state[8];
+    std::string tail;
+    uint64_t length;
+    const HashEngine *engine;
+
+    //! Construct a midstate over a constant message prefix
+    Sha256Midstate(const std::string &prefix, const HashEngine &engine = sha256_engine())
+    {
+        size_t full = prefix.size() - prefix.size() % 64;
+
+        this->engine = &engine;
+
+        for(int w = 0; w < 8; w++) state[w] = sha256_initial_state[w];
+        for(size_t off = 0; off < full; off += 64)
+            engine.compress_one(state, (const unsigned char *) prefix.data() + off);
+
+        tail = prefix.substr(full);
+        length = prefix.size() + 8;
+    }
+
+    //! finish(uint64_t, Hash256 &)
+    /*! Parameters: A nonce and a digest to be written.
+    Hashes prefix || nonce on the single message kernel.*/
+    void finish(uint64_t nonce, Hash256 &digest) const
+    {
+        finish_multi(nonce, 1, &digest, 0xffffffffu, 1);
+    }
+
+    //! prepare(Sha256NonceBuffer &)
+    /*! Parameters: A buffer to be filled.
+    Writes the tail of the prefix and the padding into every lane of the buffer.*/
+    void prepare(Sha256NonceBuffer &buffer) const
+    {
+        // The tail, the nonce and the padding span one or two blocks:
+        size_t used = tail.size() + 8;
+
+        buffer.nonce_offset = tail.size();
+        buffer.size = (used + 9 <= 64) ? 64 : 128;
+
+        for(unsigned int l = 0; l < SHA256_MAX_LANES; l++)
+        {
+            unsigned char *buf = buffer.blocks[l];
+
+            memcpy(buf, tail.data(), tail.size());
+            memset(buf + tail.size(), 0, 8);
+
+            buf[used] = 0x80;
+            memset(buf + used + 1, 0, buffer.size - used - 9);
+            store_be32(buf + buffer.size - 8, (uint32_t) ((length * 8) >> 32));
+            store_be32(buf + buffer.size - 4, (uint32_t) (length * 8));
+        }
+    }
+
+    //! finish_multi(uint64_t, unsigned int, Hash256 *, uint32_t)
+    /*! Parameters:
+
+    nonce: The first nonce.
+    count: The number of consecutive nonces, at most SHA256_MAX_LANES.
+    digests: An array receiving one digest per nonce.
+    first_word_max (optional): Digests whose first 32 bit word exceeds this value are rejected early.
+    lanes (optional): The number of lanes to be hashed at once, 1 or the lanes of the engine.
+
+    Hashes consecutive nonces at once on the multi-buffer kernel of the engine. Rejected digests are
+    not written. Returns a bit mask of the nonces whose digests have been written.*/
+    unsigned int finish_multi(uint64_t nonce, unsigned int count, Hash256 *digests,
+                              uint32_t first_word_max = 0xffffffffu, unsigned int lanes = 0) const
+    {
+        Sha256NonceBuffer buffer;
+
+        this->prepare(buffer);
+        return this->finish_multi(buffer, nonce, count, digests, first_word_max, lanes);
+    }
+
+    //! finish_multi(Sha256NonceBuffer &, uint64_t, unsigned int, Hash256 *, uint32_t)
+    /*! Same as above, on a buffer which has been filled by prepare. Only the nonce bytes are written.*/
+    unsigned int finish_multi(Sha256NonceBuffer &buffer, uint64_t nonce, unsigned int count,
+                              Hash256 *digests, uint32_t first_word_max = 0xffffffffu,
+                              unsigned int lanes = 0) const
+    {
+        unsigned int written = 0;
+        const unsigned char *blocks[SHA256_MAX_LANES];
+        uint32_t lane_state[8][SHA256_MAX_LANES];
+        size_t size = buffer.size;
+
+        if(!lanes) lanes = engine->lanes;
+        if(count > lanes) lanes = 1;
+
+        for(unsigned int l = 0; l < count; l++)
+        {
+            store_be32(buffer.blocks[l] + buffer.nonce_offset, (uint32_t) ((nonce + l) >> 32));
+            store_be32(buffer.blocks[l] + buffer.nonce_offset + 4, (uint32_t) (nonce + l));
+        }
+
+        for(unsigned int first = 0; first < count; first += lanes)
+        {
+            for(int w = 0; w < 8; w++)
+                for(unsigned int l = 0; l < lanes; l++) lane_state[w][l] = state[w];
+
+            for(size_t off = 0; off < size; off += 64)
+            {
+                // Unused lanes compress a copy of the first buffer:
+                for(unsigned int l = 0; l < lanes; l++)
+                    blocks[l] = buffer.blocks[(first + l < count) ? first + l : first] + off;
+
+                sha256_compress_lanes(*engine, lane_state, blocks, lanes);
+            }
+
+            for(unsigned int l = 0; l < lanes && first + l < count; l++)
+            {
+                if(lane_state[0][l] > first_word_max) continue;
+
+                for(int w = 0; w < 8; w++) store_be32(digests[first + l].bytes + 4 * w, lane_state[w][l]);
+                written |= 1u << (first + l);
+            }
+        }
+
+        return written;
+    }
+};
+
+//! cross_check_hash_engine(HashEngine)
+/*! Parameters: An engine supported by this CPU.
+Hashes messages of all lengths up to 200 bytes, both one by one and in batches, and finishes a
+midstate for a range of nonces. Every digest is compared against PicoSHA2.
+Returns true if all digests match.*/
+inline bool cross_check_hash_engine(const HashEngine &engine)
+{
+    std::string msgs[SHA256_MAX_LANES];
+    Hash256 digests[SHA256_MAX_LANES], expected;
+
+    for(unsigned int size = 0; size <= 200; size++)
+    {
+        for(unsigned int l = 0; l < SHA256_MAX_LANES; l++)
+        {
+            msgs[l].resize(size);
+            for(unsigned int i = 0; i < size; i++) msgs[l][i] = (char) (i * 31 + l * 7 + size);
+        }
+
+        sha256_hash_multi(msgs, engine.lanes, digests, engine);
+
+        for(unsigned int l = 0; l < engine.lanes; l++)
+        {
+            picosha2::hash256(msgs[l].begin(), msgs[l].end(), expected.bytes, expected.bytes + 32);
+            if(digests[l] != expected) return false;
+        }
+
+        sha256_hash((const unsigned char *) msgs[0].data(), size, digests[0], engine);
+        picosha2::hash256(msgs[0].begin(), msgs[0].end(), expected.bytes, expected.bytes + 32);
+        if(digests[0] != expected) return false;
+
+        // Check the midstate with the nonce in every position relative to the block boundary:
+        Sha256Midstate midstate(msgs[0], engine);
+        midstate.finish_multi(size, engine.lanes, digests);
+
+        for(unsigned int l = 0; l < engine.lanes; l++)
+        {
+            std::string msg(msgs[0]);
+            for(int b = 7; b >= 0; b--) msg += (char) ((uint64_t) (size + l) >> (8 * b));
+
+            picosha2::hash256(msg.begin(), msg.end(), expected.bytes, expected.bytes + 32);
+            if(digests[l] != expected) return false;
+        }
+    }
+
+    return true;
+}
+
+//! cross_check_hash_engines(void)
+/*! Runs cross_check_hash_engine on every engine this CPU supports.
+Returns a map from the name of each engine to the result of the check.*/
+inline std::map<std::string, bool> cross_check_hash_engines()
+{
+    std::map<std::string, bool> results;
+    const HashEngine *engines = sha256_engines();
+
+    for(int i = 0; i < SHA256_ENGINE_COUNT; i++)
+        if(engines[i].is_supported()) results[engines[i].name] = cross_check_hash_engine(engines[i]);
+
+    return results;
+}
+
+#endif
@@ -0,0 +1,109 @@
+// Copyright 2020 Falk Spickenbaum
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef TAG_INDEX_HEADER
+#define TAG_INDEX_HEADER
+#include "tag_index.hpp"
+#endif
+
+#include <algorithm>
+
+//! add(const string *, uint64_t)
+/*! Parameters: An interned string and the height of a block carrying it, above every height added before.*/
+void TagIndex::add(const std::string *tag, uint64_t height)
+{ this->heights[tag].push_back(height); }
+
+//! move(const string *, const string *, uint64_t)
+/*! Parameters: The interned string a block carried, the one it carries now and its height.
+Moves the height from the list of the old string into the list of the new one, keeping both in
+ascending order. A string no block carries any more is removed.*/
+void TagIndex::move(const std::string *from, const std::string *to, uint64_t height)
+{
+    if(from == to) return;
+
+    std::unordered_map<const std::string *, std::vector<uint64_t>>::iterator found = this->heights.find(from);
+    if(found == this->heights.end()) return;
+
+    std::vector<uint64_t> &old_heights = found->second;
+    std::vector<uint64_t>::iterator at = std::lower_bound(old_heights.begin(), old_heights.end(), height);
+    if(at == old_heights.end() || *at != height) return;
+
+    old_heights.erase(at);
+    if(old_heights.empty()) this->heights.erase(found);
+
+    std::vector<uint64_t> &new_heights = this->heights[to];
+    new_heights.insert(std::lower_bound(new_heights.begin(), new_heights.end(), height), height);
+}
+
+//! clear(void)
+/*! Removes all entries.*/
+void TagIndex::clear()
+{ this->heights.clear(); }
+
+//! count(const string *)
+/*! Parameters: An interned string, or NULL.
+Returns the number of blocks carrying it.*/
+uint64_t TagIndex::count(const std::string *tag) const
+{
+    std::unordered_map<const std::string *, std::vector<uint64_t>>::const_iterator found = this->heights.find(tag);
+    return (found == this->heights.end()) ? 0 : found->second.size();
+}
+
+//! get(const string *)
+/*! Parameters: An interned string, or NULL.
+Returns the heights of the blocks carrying it in ascending order, NULL if there are none. The list
+grows as blocks are added and is invalidated by clear().*/
+const std::vector<uint64_t> *TagIndex::get(const std::string *tag) const
+{
+    std::unordered_map<const std::string *, std::vector<uint64_t>>::const_iterator found = this->heights.find(tag);
+    return (found == this->heights.end()) ? NULL : &found->second;
+}
+
+//! counts(void)
+/*! Returns the number of blocks per string. Takes time proportional to the number of distinct strings.*/
+std::map<std::string, uint64_t> TagIndex::counts() const
+{
+    std::map<std::string, uint64_t> counts;
+    std::unordered_map<const std::string *, std::vector<uint64_t>>::const_iterator i;
+
+    for(i = this->heights.begin(); i != this->heights.end(); ++i) counts[*i->first] = i->second.size();
+    return counts;
+}
+
+//! find(const string *, uint64_t, uint64_t, bool)
+/*! Parameters:
+
+tag: An interned string, or NULL.
+offset: The number of matching blocks to be skipped.
+limit: The maximum number of heights to be returned.
+reverse: If true, the blocks are ordered from the highest to the lowest height.
+
+Returns a page of the heights of the blocks carrying the tag, in ascending order unless reversed.
+Takes time proportional to the size of the page.*/
+std::vector<uint64_t> TagIndex::find(const std::string *tag, uint64_t offset, uint64_t limit, bool reverse) const
+{
+    std::unordered_map<const std::string *, std::vector<uint64_t>>::const_iterator found = this->heights.find(tag);
+    std::vector<uint64_t> page;
+
+    if(found == this->heights.end() || offset >= found->second.size()) return page;
+
+    const std::vector<uint64_t> &all = found->second;
+    uint64_t count = std::min(limit, (uint64_t) all.size() - offset);
+
+    if(reverse) page.assign(all.rbegin() + offset, all.rbegin() + offset + count);
+    else page.assign(all.begin() + offset, all.begin() + offset + count);
+
+    return page;
+}
@@ -0,0 +1,49 @@
+// Copyright 2020 Falk Spickenbaum
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef TAG_INDEX_HPP
+#define TAG_INDEX_HPP
+
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <stdint.h>
+
+//! TagIndex
+/*! An inverted index from an interned string, such as the metadata tag of a block, to the heights
+of the blocks carrying it in ascending order. Since interned strings are unique, the index is keyed
+by their address and never compares strings. Blocks have to be added in ascending order of height,
+but may be moved to another string later.*/
+class TagIndex {
+
+    private:
+
+        std::unordered_map<const std::string *, std::vector<uint64_t>> heights;
+
+    protected:
+    public:
+
+        void add(const std::string *tag, uint64_t height);
+        void move(const std::string *from, const std::string *to, uint64_t height);
+        void clear();
+
+        uint64_t count(const std::string *tag) const;
+        const std::vector<uint64_t> *get(const std::string *tag) const;
+        std::map<std::string, uint64_t> counts() const;
+        std::vector<uint64_t> find(const std::string *tag, uint64_t offset, uint64_t limit, bool reverse) const;
+};
+
+#endif
@@ -0,0 +1,227 @@
+// Copyright 2020 Falk Spickenbaum
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef TIME_INDEX_HEADER
+#define TIME_INDEX_HEADER
+#include "time_index.hpp"
+#endif
+
+#include <algorithm>
+#include <stdexcept>
+
+//! Construct an empty TimeIndex
+TimeIndex::TimeIndex() : max_skew(0), min_interval(0), max_interval(0) {}
+
+//! add(uint64_t)
+/*! Parameters: The timestamp of the block above every block added before.*/
+void TimeIndex::add(uint64_t timestamp)
+{
+    uint64_t max_time = this->max_times.empty() ? timestamp : std::max(this->max_times.back(), timestamp);
+
+    this->max_skew = std::max(this->max_skew, max_time - timestamp);
+
+    if(!this->times.empty())
+    {
+        int64_t interval = (int64_t) (timestamp - this->times.back());
+        bool first = this->times.size() == 1;
+
+        this->min_interval = first ? interval : std::min(this->min_interval, interval);
+        this->max_interval = first ? interval : std::max(this->max_interval, interval);
+    }
+
+    this->times.push_back(timestamp);
+    this->max_times.push_back(max_time);
+
+    std::map<uint64_t, std::map<uint64_t, uint64_t> >::iterator it;
+    for(it = this->histograms.begin(); it != this->histograms.end(); it++)
+        it->second[timestamp - timestamp % it->first]++;
+}
+
+//! clear(void)
+/*! Removes all entries.*/
+void TimeIndex::clear()
+{
+    this->times.clear();
+    this->max_times.clear();
+    this->max_skew = 0;
+    this->min_interval = this->max_interval = 0;
+    this->histograms.clear();
+    this->histogram_widths.clear();
+}
+
+//! get_max_skew(void)
+/*! Returns the largest amount by which a timestamp fell behind an earlier one, 0 if the timestamps are monotone.*/
+uint64_t TimeIndex::get_max_skew() const
+{ return this->max_skew; }
+
+//! window(uint64_t, uint64_t, uint64_t &, uint64_t &)
+/*! Parameters: The earliest timestamp and the timestamp after the latest one to be matched, and the
+first and last height of the window, which are set.
+Narrows down the heights of the blocks with start <= timestamp < end to first <= height < last. A
+block below the first height whose running maximum reaches start is older than start, and a block
+at or above the first height whose running maximum reaches end + max_skew is not older than end.
+Blocks within the window still have to be compared.*/
+void TimeIndex::window(uint64_t start, uint64_t end, uint64_t &first, uint64_t &last) const
+{
+    first = last = 0;
+    if(start >= end) return;
+
+    uint64_t bound = (end > UINT64_MAX - this->max_skew) ? UINT64_MAX : end + this->max_skew;
+    first = std::lower_bound(this->max_times.begin(), this->max_times.end(), start) - this->max_times.begin();
+    last = std::lower_bound(this->max_times.begin() + first, this->max_times.end(), bound) -
+           this->max_times.begin();
+
+    // The block at the bound may still be older than end if its own timestamp is:
+    if(bound == UINT64_MAX) last = this->times.size();
+}
+
+//! find(uint64_t, uint64_t, uint64_t, uint64_t, bool)
+/*! Parameters:
+
+start: The earliest timestamp to be matched.
+end: The timestamp after the latest one to be matched.
+offset: The number of matching blocks to be skipped.
+limit: The maximum number of heights to be returned.
+reverse: If true, the blocks are ordered from the highest to the lowest height.
+
+Returns a page of the heights of the blocks with start <= timestamp < end, in ascending order unless
+reversed. Only the blocks within the window are compared.*/
+std::vector<uint64_t> TimeIndex::find(uint64_t start, uint64_t end, uint64_t offset, uint64_t limit,
+                                      bool reverse) const
+{
+    std::vector<uint64_t> page;
+    uint64_t first, last;
+
+    this->window(start, end, first, last);
+
+    for(uint64_t i = 0; i < last - first && page.size() < limit; i++)
+    {
+        uint64_t height = reverse ? last - 1 - i : first + i;
+        if(this->times[height] < start || this->times[height] >= end) continue;
+
+        if(offset) offset--;
+        else page.push_back(height);
+    }
+
+    return page;
+}
+
+//! count(map<uint64_t, uint64_t> &, uint64_t, uint64_t, uint64_t)
+/*! Parameters: The counts per bucket to be added to, the earliest timestamp and the timestamp after
+the latest one to be counted, and the width of a bucket.
+Counts the blocks within the window into their buckets, reading only the timestamps within the window.*/
+void TimeIndex::count(std::map<uint64_t, uint64_t> &counts, uint64_t start, uint64_t end, uint64_t bucket) const
+{
+    uint64_t first, last;
+
+    this->window(start, end, first, last);
+
+    for(uint64_t i = first; i < last; i++)
+        if(this->times[i] >= start && this->times[i] < end) counts[this->times[i] - this->times[i] % bucket]++;
+}
+
+//! full_histogram(uint64_t)
+/*! Parameters: The width of a bucket.
+Returns the number of blocks per bucket over all blocks. The first request for a width reads every
+timestamp, later blocks are counted as they are added. Only the last TIME_INDEX_HISTOGRAM_WIDTHS
+widths are kept.*/
+const std::map<uint64_t, uint64_t> &TimeIndex::full_histogram(uint64_t bucket) const
+{
+    std::map<uint64_t, std::map<uint64_t, uint64_t> >::iterator found = this->histograms.find(bucket);
+    if(found != this->histograms.end()) return found->second;
+
+    if(this->histogram_widths.size() == TIME_INDEX_HISTOGRAM_WIDTHS)
+    {
+        this->histograms.erase(this->histogram_widths.front());
+        this->histogram_widths.erase(this->histogram_widths.begin());
+    }
+
+    std::map<uint64_t, uint64_t> &counts = this->histograms[bucket];
+    this->histogram_widths.push_back(bucket);
+
+    for(uint64_t i = 0; i < this->times.size(); i++) counts[this->times[i] - this->times[i] % bucket]++;
+    return counts;
+}
+
+//! histogram(uint64_t, uint64_t, uint64_t)
+/*! Parameters: The earliest timestamp and the timestamp after the latest one to be counted, and the
+width of a bucket.
+Returns the number of blocks per bucket, keyed by the earliest timestamp of the bucket, i.e. a
+multiple of the width. Empty buckets are left out. Buckets which lie within the window entirely are
+taken from the histogram kept for the width; only the timestamps of the buckets cut by the start or
+the end of the window are read. Throws an invalid_argument exception if the width is 0.*/
+std::map<uint64_t, uint64_t> TimeIndex::histogram(uint64_t start, uint64_t end, uint64_t bucket) const
+{
+    if(!bucket) throw std::invalid_argument("The width of a bucket must not be 0.");
+
+    std::map<uint64_t, uint64_t> counts;
+    if(start >= end) return counts;
+
+    // The buckets from first_full up to last_full lie within the window:
+    uint64_t first_full = start - start % bucket;
+    if(start % bucket) first_full = (first_full > UINT64_MAX - bucket) ? end : first_full + bucket;
+    uint64_t last_full = end - end % bucket;
+
+    if(first_full >= last_full)
+    {
+        this->count(counts, start, end, bucket);
+        return counts;
+    }
+
+    const std::map<uint64_t, uint64_t> &full = this->full_histogram(bucket);
+
+    this->count(counts, start, first_full, bucket);
+    counts.insert(full.lower_bound(first_full), full.lower_bound(last_full));
+    this->count(counts, last_full, end, bucket);
+
+    return counts;
+}
+
+//! interval_stats(uint64_t)
+/*! Parameters: The number of newest blocks to be covered, or more to cover all blocks.
+Returns the statistics of the times between consecutive blocks among the newest blocks. The mean
+only depends on the first and the last timestamp; the smallest and largest time are read from the
+window, or from the values kept for all blocks, so the cost does not depend on the number of blocks
+outside the window.*/
+BlockTimeStats TimeIndex::interval_stats(uint64_t window) const
+{
+    BlockTimeStats stats = { 0, 0, 0, 0, 0 };
+    uint64_t size = this->times.size();
+
+    stats.blocks = std::min(window, size);
+    if(stats.blocks < 2) return stats;
+
+    uint64_t first = size - stats.blocks;
+    stats.intervals = stats.blocks - 1;
+    stats.mean = (double) (int64_t) (this->times[size - 1] - this->times[first]) / (double) stats.intervals;
+
+    if(first == 0)
+    {
+        stats.min = this->min_interval;
+        stats.max = this->max_interval;
+        return stats;
+    }
+
+    stats.min = stats.max = (int64_t) (this->times[first + 1] - this->times[first]);
+
+    for(uint64_t i = first + 2; i < size; i++)
+    {
+        int64_t interval = (int64_t) (this->times[i] - this->times[i - 1]);
+        stats.min = std::min(stats.min, interval);
+        stats.max = std::max(stats.max, interval);
+    }
+
+    return stats;
+}
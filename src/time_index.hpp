@@ -0,0 +1,84 @@
+// Copyright 2020 Falk Spickenbaum
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef TIME_INDEX_HPP
+#define TIME_INDEX_HPP
+
+#include <map>
+#include <vector>
+#include <stdint.h>
+
+// Number of bucket widths whose histograms a TimeIndex keeps up to date:
+#define TIME_INDEX_HISTOGRAM_WIDTHS 4
+
+//! BlockTimeStats
+/*! The times between consecutive blocks of a range of blocks, in milliseconds. Intervals are
+negative where a block's timestamp lies before its predecessor's.*/
+struct BlockTimeStats {
+
+    uint64_t blocks;
+    uint64_t intervals;
+    double mean;
+    int64_t min;
+    int64_t max;
+};
+
+//! TimeIndex
+/*! An index from the timestamps of the blocks to their heights. Timestamps usually grow with the
+height, but clocks of different nodes may disagree. The index keeps the running maximum of the
+timestamps, which always grows, and the largest amount by which a timestamp fell behind it. A time
+window is located by binary search over the running maximum, widened by that amount, so a monotone
+ledger is searched exactly and a ledger with skewed clocks only scans the blocks around the window.
+The smallest and largest time between consecutive blocks are kept as well, so statistics over the
+whole ledger do not have to visit every block. The histograms of the last few bucket widths asked
+for are counted along as blocks are added, so only the buckets cut by the ends of a window are read
+from the timestamps. Blocks have to be added in ascending order of height, starting at height 0.
+
+Not safe to be used from several threads at once, not even for reading.*/
+class TimeIndex {
+
+    private:
+
+        std::vector<uint64_t> times;
+        std::vector<uint64_t> max_times;
+        uint64_t max_skew;
+        int64_t min_interval;
+        int64_t max_interval;
+
+        // Number of blocks per bucket, by width of the buckets, and the widths in the order they were asked for:
+        mutable std::map<uint64_t, std::map<uint64_t, uint64_t> > histograms;
+        mutable std::vector<uint64_t> histogram_widths;
+
+        void count(std::map<uint64_t, uint64_t> &counts, uint64_t start, uint64_t end, uint64_t bucket) const;
+        const std::map<uint64_t, uint64_t> &full_histogram(uint64_t bucket) const;
+
+    protected:
+    public:
+
+        TimeIndex();
+
+        void add(uint64_t timestamp);
+        void clear();
+
+        uint64_t get_max_skew() const;
+        void window(uint64_t start, uint64_t end, uint64_t &first, uint64_t &last) const;
+        std::vector<uint64_t> find(uint64_t start, uint64_t end, uint64_t offset, uint64_t limit,
+                                   bool reverse) const;
+
+        std::map<uint64_t, uint64_t> histogram(uint64_t start, uint64_t end, uint64_t bucket) const;
+        BlockTimeStats interval_stats(uint64_t window) const;
+};
+
+#endif
@@ -0,0 +1,183 @@
+// Copyright 2020 Falk Spickenbaum
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef WORKER_POOL_HEADER
+#define WORKER_POOL_HEADER
+#include "worker_pool.hpp"
+#endif
+
+#include <algorithm>
+
+//! Construct a WorkerPool object
+/*! Parameters: The number of threads to be started.*/
+WorkerPool::WorkerPool(unsigned int size)
+{
+    this->job = NULL;
+    this->task_count = 0;
+    this->next_task = 0;
+    this->pending = 0;
+    this->stopping = false;
+
+    this->start(size);
+}
+
+//! Stops and joins all threads.
+WorkerPool::~WorkerPool()
+{ this->stop(); }
+
+//! start(unsigned int)
+/*! Parameters: The number of threads to be started.*/
+void WorkerPool::start(unsigned int size)
+{
+    this->stopping = false;
+
+    for(unsigned int i = 0; i < size; i++)
+        this->threads.push_back(std::thread(&WorkerPool::work, this));
+}
+
+//! stop(void)
+/*! Wakes up all parked threads, tells them to exit and joins them.*/
+void WorkerPool::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->stopping = true;
+    }
+
+    this->wake.notify_all();
+
+    for(unsigned int i = 0; i < this->threads.size(); i++)
+        this->threads[i].join();
+
+    this->threads.clear();
+}
+
+//! work(void)
+/*! The loop run by every thread of the pool: parks until a task is available, runs it and
+reports back once it has finished.*/
+void WorkerPool::work()
+{
+    std::unique_lock<std::mutex> lock(this->mutex);
+
+    while(true)
+    {
+        this->wake.wait(lock, [this]{ return this->stopping || this->next_task < this->task_count; });
+        if(this->stopping) return;
+
+        unsigned int task = this->next_task++;
+        lock.unlock();
+
+        try
+        { (*this->job)(task); }
+        catch(...)
+        {
+            std::lock_guard<std::mutex> error_lock(this->mutex);
+            if(!this->error) this->error = std::current_exception();
+        }
+
+        lock.lock();
+        if(--this->pending == 0) this->done.notify_all();
+    }
+}
+
+//! run(unsigned int, function<void(unsigned int)>)
+/*! Parameters: The number of tasks, and the job to be run once per task with the index of the task.
+Runs the tasks on the threads of the pool and returns once all of them have finished. If there
+are more tasks than threads, threads take on further tasks as they become free.
+Rethrows the first exception thrown by a task.*/
+void WorkerPool::run(unsigned int tasks, const std::function<void(unsigned int)> &job)
+{
+    if(!tasks) return;
+
+    std::lock_guard<std::mutex> serial(this->run_mutex);
+    std::exception_ptr error;
+
+    if(this->threads.empty())
+    {
+        // Without a pool, every task gets a thread of its own:
+        std::vector<std::thread> temporary;
+        std::mutex error_mutex;
+
+        for(unsigned int i = 0; i < tasks; i++)
+            temporary.push_back(std::thread([&job, &error, &error_mutex, i]{
+                try { job(i); }
+                catch(...)
+                {
+                    std::lock_guard<std::mutex> lock(error_mutex);
+                    if(!error) error = std::current_exception();
+                }
+            }));
+
+        for(unsigned int i = 0; i < tasks; i++) temporary[i].join();
+    }
+    else
+    {
+        std::unique_lock<std::mutex> lock(this->mutex);
+
+        this->job = &job;
+        this->error = std::exception_ptr();
+        this->task_count = tasks;
+        this->next_task = 0;
+        this->pending = tasks;
+
+        this->wake.notify_all();
+        this->done.wait(lock, [this]{ return this->pending == 0; });
+
+        this->job = NULL;
+        this->task_count = 0;
+        this->next_task = 0;
+        error = this->error;
+    }
+
+    if(error) std::rethrow_exception(error);
+}
+
+//! resize(unsigned int)
+/*! Parameters: The new number of threads. 0 stops the pool.
+Waits for a running job to finish, then replaces the threads of the pool.*/
+void WorkerPool::resize(unsigned int size)
+{
+    std::lock_guard<std::mutex> serial(this->run_mutex);
+
+    this->stop();
+    this->start(size);
+}
+
+//! get_size(void)
+/*! Returns the number of threads in the pool.*/
+unsigned int WorkerPool::get_size()
+{
+    std::lock_guard<std::mutex> serial(this->run_mutex);
+    return (unsigned int) this->threads.size();
+}
+
+//! worker_pool(void)
+/*! Returns the pool shared by all Blockchain objects of this process. It is started on first use,
+with one thread per hardware thread.*/
+WorkerPool &worker_pool()
+{
+    static WorkerPool pool(std::max(1u, std::thread::hardware_concurrency()));
+    return pool;
+}
+
+//! set_pool_size(unsigned int)
+/*! Parameters: The number of threads of the shared pool. 0 stops the pool, after which every
+parallel job starts threads of its own.*/
+void set_pool_size(unsigned int size)
+{ worker_pool().resize(size); }
+
+//! get_pool_size(void)
+/*! Returns the number of threads of the shared pool.*/
+unsigned int get_pool_size()
+{ return worker_pool().get_size(); }
@@ -0,0 +1,67 @@
+// Copyright 2020 Falk Spickenbaum
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef WORKER_POOL_HPP
+#define WORKER_POOL_HPP
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//! WorkerPool
+/*! A fixed set of long-lived threads which park between jobs. A job is split into a number of
+tasks, each of which is handed its index and run on one of the threads; run(...) returns once
+all tasks have finished. A pool of size 0 starts a temporary thread per task instead.
+
+Jobs from different callers are run one after the other.*/
+class WorkerPool {
+
+    private:
+
+        std::vector<std::thread> threads;
+        std::mutex mutex;
+        std::mutex run_mutex;
+        std::condition_variable wake;
+        std::condition_variable done;
+
+        const std::function<void(unsigned int)> *job;
+        unsigned int task_count;
+        unsigned int next_task;
+        unsigned int pending;
+        bool stopping;
+        std::exception_ptr error;
+
+        void work();
+        void start(unsigned int size);
+        void stop();
+
+    protected:
+    public:
+
+        WorkerPool(unsigned int size);
+        ~WorkerPool();
+
+        void run(unsigned int tasks, const std::function<void(unsigned int)> &job);
+        void resize(unsigned int size);
+        unsigned int get_size();
+};
+
+WorkerPool &worker_pool();
+void set_pool_size(unsigned int size);
+unsigned int get_pool_size();
+
+#endif
@@ -14,6 +14,9 @@
 
 from swiftchain import Block
 import unittest
+import hashlib
+import struct
+import time
 
 class TestBlock(unittest.TestCase):
 
@@ -43,6 +46,31 @@ class TestBlock(unittest.TestCase):
         block = Block(data="Some Data", user_addr="Tester")
         self.assertIsNotNone(block.get_block_hash())
 
+    def test_get_header(self):
+
+        genesis = Block(data="Genesis", user_addr="Tester")
+        block = Block(prev=genesis, data="Some Data", user_addr="Tester", nonce=42, difficulty=3, meta_data="Meta")
+
+        header = block.get_header()
+        version, difficulty, height, timestamp, prev_hash, payload_hash, nonce = struct.unpack(">IIQQ32s32sQ", header)
+
+        self.assertEqual(96, len(header))
+        self.assertEqual(2, version)
+        self.assertEqual(block.get_difficulty(), difficulty)
+        self.assertEqual(block.get_block_id(), height)
+        self.assertEqual(block.get_timestamp(), timestamp)
+        self.assertEqual(genesis.get_block_hash(), prev_hash.hex())
+        self.assertEqual(block.get_nonce(), nonce)
+
+        # The header commits to the payload by its digest, each field prefixed by its length:
+        payload = b"".join(len(field).to_bytes(8, "big") + field for field in [b"Tester", b"Meta", b"Some Data"])
+
+        self.assertEqual(hashlib.sha256(payload).digest(), payload_hash)
+        self.assertEqual(hashlib.sha256(header).hexdigest(), block.get_block_hash())
+
+        # The Genesis block has no previous block:
+        self.assertEqual(bytes(32), genesis.get_header()[24:56])
+
     def test_get_nonce(self):
 
         block = Block(data="Some Data", user_addr="Tester")
@@ -53,6 +81,14 @@ class TestBlock(unittest.TestCase):
         block = Block(data="Some Data", user_addr="Tester")
         self.assertEqual(0, block.get_difficulty())
 
+    def test_get_timestamp(self):
+
+        block = Block(data="Some Data", user_addr="Tester")
+        age = int(time.time() * 1000) - block.get_timestamp()
+
+        # Milliseconds since the block was created:
+        self.assertTrue(0 <= age < 10000)
+
     def test_get_data(self):
 
         block = Block(data="Some Data", user_addr="Tester")
@@ -63,6 +99,18 @@ class TestBlock(unittest.TestCase):
         block = Block(data="Genesis", user_addr="Tester")
         self.assertEqual("GENESIS", block.get_meta_data())
 
+    def test_hash(self):
+
+        block = Block(data="Some Data", user_addr="Tester")
+        block_hash = hash(block)
+
+        # The hash follows the block hash, which the setters do not change:
+        block.set_meta_data(meta_data="CHANGED")
+
+        self.assertEqual(block_hash, hash(block))
+        self.assertEqual(1, len({block, block}))
+        self.assertEqual("Some Data", {block: "Some Data"}[block])
+
     def test_set_meta_data(self):
 
         block = Block(data="Genesis", user_addr="Tester")
@@ -1,11 +1,11 @@
 # Copyright 2020 Falk Spickenbaum
-# 
+#
 # Licensed under the Apache License, Version 2.0 (the "License");
 # you may not use this file except in compliance with the License.
 # You may obtain a copy of the License at
-# 
+#
 #     http://www.apache.org/licenses/LICENSE-2.0
-# 
+#
 # Unless required by applicable law or agreed to in writing, software
 # distributed under the License is distributed on an "AS IS" BASIS,
 # WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
@@ -13,7 +13,9 @@
 # limitations under the License.
 
 import unittest
-from swiftchain import Blockchain, Block, Node
+import gc
+from swiftchain import Blockchain, Block, Node, set_pool_size, get_pool_size, cross_check_hash_index
+from swiftchain import benchmark_block_memory
 
 class TestBlockchain(unittest.TestCase):
 
@@ -41,7 +43,7 @@ class TestBlockchain(unittest.TestCase):
 
         self.assertEqual(1, blockchain.get_ledger_size())
 
-        for i in range(100): 
+        for i in range(100):
             tester_node.write_data(data=str(i), chain=blockchain)
 
         self.assertEqual(101, blockchain.get_ledger_size())
@@ -55,7 +57,7 @@ class TestBlockchain(unittest.TestCase):
 
         while not test_block:
             test_block = blockchain.mine_block(data="Test", node_addr="8367")
-        
+
         ledger = blockchain.get_ledger()
 
         self.assertIsNotNone(ledger[g_block_hash])
@@ -150,6 +152,52 @@ class TestBlockchain(unittest.TestCase):
 
         self.assertEqual(['95', '96', '97', '98', '99'], data)
 
+    def test_get_block_by_hash(self):
+
+        tester_node = Node("Tester")
+        blockchain = Blockchain(diff_threshold=100000, g_data="Test")
+
+        for i in range(3000):
+            tester_node.write_data(data=str(i), chain=blockchain)
+
+        # The hash index has grown several times, and still finds every block:
+        ledger = blockchain.get_ledger()
+
+        for block in blockchain.get_blocks_by_range(3001):
+            self.assertEqual(block, blockchain.get_block(block.get_block_hash()))
+            self.assertIn(block.get_block_hash(), ledger)
+
+        self.assertIsNone(blockchain.get_block("0" * 64))
+        self.assertNotIn("0" * 64, ledger)
+
+        # Duplicate hashes, and hashes sharing a slot, are checked against std::map:
+        results = cross_check_hash_index(20000)
+
+        self.assertEqual(["duplicate", "lookup", "missing"], sorted(results.keys()))
+        self.assertTrue(all(results.values()))
+
+    def test_get_block_by_index(self):
+
+        tester_node = Node("Tester")
+        blockchain = Blockchain(g_data="Test")
+
+        for i in range(50):
+            tester_node.write_data(data=str(i), chain=blockchain)
+
+        # Blocks are stored by height, with each block following its predecessor:
+        for i in range(1, 51):
+            block = blockchain.get_block_by_index(i)
+
+            self.assertEqual(i, block.get_block_id())
+            self.assertEqual(str(i - 1), block.get_data())
+            self.assertEqual(blockchain.get_block_by_index(i - 1).get_block_hash(), block.get_prev_hash())
+            self.assertEqual(block, blockchain.get_block(block.get_block_hash()))
+
+        self.assertEqual(blockchain.get_block_by_index(50), blockchain.get_last_block())
+        self.assertEqual(51, len(blockchain.get_blocks_by_range(51)))
+        self.assertRaises(IndexError, blockchain.get_block_by_index, 51)
+        self.assertRaises(IndexError, blockchain.get_blocks_by_range, 52)
+
 
     def test_find_consensus(self):
 
@@ -160,16 +208,56 @@ class TestBlockchain(unittest.TestCase):
 
         for i in range(100):
             tester_node.write_data(data=str(i), chain=blockchain1)
-        
+
         for i in range(80):
             tester_node.write_data(data=str(i), chain=blockchain2)
 
-        # Blockchain 2 has a higher difficulty threshold, thus it will have a 
+        # Blockchain 2 has a higher difficulty threshold, thus it will have a
         # higher cumulative proof-of-work despite mining fewer blocks:
         self.assertFalse(blockchain2.find_consensus(blockchain1))
         self.assertTrue(blockchain1.find_consensus(blockchain2))
         self.assertEqual(blockchain1.get_last_block(), blockchain2.get_last_block())
-    
+        self.assertEqual(hash(blockchain1.get_last_block()), hash(blockchain2.get_last_block()))
+
+    def test_find_consensus_keeps_blocks(self):
+
+        tester_node = Node("Tester")
+
+        blockchain1 = Blockchain(diff_threshold=100000, g_data="Chain 1")
+        blockchain2 = Blockchain(diff_threshold=100000, g_data="Chain 2")
+
+        for i in range(5):
+            tester_node.write_data(data="1-" + str(i), chain=blockchain1)
+
+        for i in range(50):
+            tester_node.write_data(data="2-" + str(i), chain=blockchain2)
+
+        old_blocks = [blockchain1.get_last_block(), blockchain1.get_block_by_index(2)]
+        old_blocks += list(blockchain1.get_ledger().values())
+        ledger = blockchain1.get_ledger()
+
+        self.assertTrue(blockchain1.find_consensus(blockchain2))
+
+        # Blocks of the replaced ledger stay valid until the chain is destroyed:
+        gc.collect()
+        junk = [Blockchain(g_data="x" * 1000) for i in range(20)]
+
+        self.assertEqual(["1-4", "1-1"], [block.get_data() for block in old_blocks[:2]])
+        self.assertEqual(["Chain 1"] + ["1-" + str(i) for i in range(5)], [block.get_data() for block in old_blocks[2:]])
+
+        # The view follows the chain to its new ledger, which holds copies of the foreign blocks:
+        self.assertEqual(51, len(ledger))
+        self.assertEqual("2-49", blockchain1.get_last_block().get_data())
+
+        blockchain1.get_last_block().set_meta_data("Changed")
+        self.assertEqual("", blockchain2.get_last_block().get_meta_data())
+
+        # A block keeps the chain that owns it alive:
+        block = Blockchain(g_data="Dropped").get_last_block()
+        gc.collect()
+
+        self.assertEqual("Dropped", block.get_data())
+
     def test_mine_block(self):
 
         blockchain = Blockchain()
@@ -182,6 +270,33 @@ class TestBlockchain(unittest.TestCase):
         self.assertTrue(blockchain.verify_block(test_block))
         self.assertEqual(blockchain.get_last_block(), test_block)
 
+    def test_mine_block_template(self):
+
+        blockchain = Blockchain(try_limit=1000, g_data="Test")
+        genesis = blockchain.get_last_block()
+
+        # A failed attempt hashes every nonce up to the try limit and leaves the ledger as it was:
+        blockchain.set_difficulty(64)
+
+        self.assertIsNone(blockchain.mine_block(data="Test", node_addr="8367"))
+        self.assertEqual(1000, sum(worker.hashes for worker in blockchain.get_mining_coverage()))
+        self.assertEqual(1, blockchain.get_ledger_size())
+        self.assertEqual(genesis, blockchain.get_last_block())
+
+        # Only the winning nonce becomes a block, whatever the size of its payload:
+        blockchain.set_difficulty(4)
+        data = "x" * 100000
+        test_block = None
+
+        while not test_block:
+            test_block = blockchain.mine_block(data=data, node_addr="8367", meta_data="Large")
+
+        self.assertEqual(2, blockchain.get_ledger_size())
+        self.assertEqual(data, test_block.get_data())
+        self.assertEqual("Large", test_block.get_meta_data())
+        self.assertEqual(genesis.get_block_hash(), test_block.get_prev_hash())
+        self.assertTrue(blockchain.verify_block(test_block))
+
     def test_mine_block_concurrently(self):
 
         blockchain = Blockchain()
@@ -194,4 +309,294 @@ class TestBlockchain(unittest.TestCase):
         self.assertTrue(blockchain.verify_block(test_block))
         self.assertEqual(blockchain.get_last_block(), test_block)
 
+    def test_get_mining_coverage(self):
+
+        blockchain = Blockchain(try_limit=50000, g_data="Test")
+        blockchain.set_difficulty(64)
+
+        self.assertIsNone(blockchain.mine_block_concurrently(data="Test", node_addr="8367", threads=4))
+
+        # The workers hash disjoint ranges of nonces, which together cover the try limit once:
+        coverage = blockchain.get_mining_coverage()
+        ranges = sorted(nonces for worker in coverage for nonces in worker.ranges)
+
+        # There is one worker per thread, but no more than hardware threads:
+        self.assertTrue(1 <= len(coverage) <= 4)
+        self.assertEqual(50000, sum(worker.hashes for worker in coverage))
+        self.assertEqual(0, ranges[0][0])
+        self.assertEqual(50000, ranges[-1][1])
+
+        for first, second in zip(ranges, ranges[1:]):
+            self.assertEqual(first[1], second[0])
+
+        for worker in coverage:
+            self.assertEqual(worker.hashes, sum(stop - start for start, stop in worker.ranges))
+
+    def test_set_pool_size(self):
+
+        tester_node = Node("Tester")
+        blockchain = Blockchain(g_data="Test")
+        pool_size = get_pool_size()
+
+        # Without a pool, every attempt starts threads of its own:
+        try:
+            for size in [0, 2, 1]:
+                set_pool_size(size)
+                self.assertEqual(size, get_pool_size())
+
+                for i in range(5):
+                    tester_node.write_data(data=str(i), chain=blockchain, threads=2)
+
+                self.assertIsNone(blockchain.validate_chain(threads=2))
+        finally:
+            set_pool_size(pool_size)
+
+        self.assertEqual(pool_size, get_pool_size())
+        self.assertEqual(16, blockchain.get_ledger_size())
+
+    def test_mining_stops_at_winner(self):
+
+        blockchain = Blockchain(try_limit=100000000, g_data="Test")
+        blockchain.set_difficulty(12)
+        pool_size = get_pool_size()
+
+        # The first winning nonce stops every worker, with or without a pool:
+        try:
+            for size in [pool_size, 0]:
+                set_pool_size(size)
+                test_block = blockchain.mine_block_concurrently(data="Test", node_addr="8367", threads=4)
+
+                coverage = blockchain.get_mining_coverage()
+                nonce = test_block.get_nonce()
+
+                self.assertTrue(blockchain.verify_block(test_block))
+                self.assertTrue(any(start <= nonce < stop for worker in coverage for start, stop in worker.ranges))
+                self.assertTrue(sum(worker.hashes for worker in coverage) < 1000000)
+        finally:
+            set_pool_size(pool_size)
+
+    def test_get_blocks_by_time(self):
+
+        tester_node = Node("Tester")
+        blockchain = Blockchain(g_data="Test")
+
+        for i in range(10): tester_node.write_data(data=str(i), chain=blockchain)
+
+        start = blockchain.get_block_by_index(0).get_timestamp()
+        end = blockchain.get_last_block().get_timestamp() + 1
+        data = [block.get_data() for block in blockchain.get_blocks_by_time(start, end, reverse=True)]
+
+        self.assertEqual([str(i) for i in range(9, -1, -1)] + ["Test"], data)
+        self.assertEqual([], blockchain.get_blocks_by_time(end, end + 1000))
+        self.assertEqual(["0", "1"], [block.get_data() for block in blockchain.get_blocks_by_time(start, end, 1, 2)])
+
+    def test_iter_blocks(self):
+
+        tester_node = Node("Tester")
+        blockchain = Blockchain(g_data="Test")
+
+        for i in range(10): tester_node.write_data(data=str(i), chain=blockchain)
+
+        data = [block.get_data() for block in blockchain.iter_blocks()]
+        self.assertEqual(["Test"] + [str(i) for i in range(10)], data)
+
+        data = [block.get_data() for block in blockchain.iter_blocks(start=-1, stop=0, step=-3)]
+        self.assertEqual(["9", "6", "3", "0"], data)
+
+        # Blocks appended while iterating are not reached:
+        for block in blockchain.iter_blocks(): tester_node.write_data(data="More", chain=blockchain)
+        self.assertEqual(22, blockchain.get_ledger_size())
+
+    def test_search_data(self):
+
+        tester_node = Node("Tester")
+        blockchain = Blockchain(g_data="Test")
+
+        for i in range(30): tester_node.write_data(data="Order " + str(i) + " shipped", chain=blockchain)
+
+        self.assertEqual([3, 13, 23], blockchain.search_data("2 shipped", output="heights"))
+        self.assertEqual([30, 29], blockchain.search_data("shipped", limit=2, threads=2, reverse=True, output="heights"))
+        self.assertEqual("Order 13 shipped", blockchain.search_data(b"13")[0].get_data())
+        self.assertEqual([], blockchain.search_data("Not contained inside"))
+
+    def test_aggregation(self):
+
+        tester_node = Node("Tester")
+        other_node = Node("Other")
+        blockchain = Blockchain(g_data="Test", node_addr=tester_node.get_node_addr())
+
+        for i in range(10):
+            node = tester_node if i < 7 else other_node
+            node.write_data(data=str(i), chain=blockchain, meta_data="Meta " + str(i % 2))
+
+        self.assertEqual({"GENESIS": 1, "Meta 0": 5, "Meta 1": 5}, blockchain.count_by_meta())
+        self.assertEqual({tester_node.get_node_addr(): 8, other_node.get_node_addr(): 3}, blockchain.count_by_node())
+        self.assertEqual(11, sum(blockchain.count_by_difficulty().values()))
+        self.assertEqual(11, sum(blockchain.histogram_by_time(bucket=1000).values()))
+
+        stats = blockchain.block_time_stats(window=5)
+        self.assertEqual((5, 4), (stats.blocks, stats.intervals))
+        self.assertTrue(stats.min <= stats.mean <= stats.max)
+
+        # The counts follow tags changed on blocks of the ledger:
+        blockchain.get_block_by_index(1).set_meta_data("Meta 1")
+        blockchain.get_block_by_index(7).set_node_addr(other_node.get_node_addr())
+
+        self.assertEqual({"GENESIS": 1, "Meta 0": 4, "Meta 1": 6}, blockchain.count_by_meta())
+        self.assertEqual({tester_node.get_node_addr(): 7, other_node.get_node_addr(): 4}, blockchain.count_by_node())
+
+    def test_query(self):
+
+        tester_node = Node("Tester")
+        other_node = Node("Other")
+        blockchain = Blockchain(g_data="Test")
+
+        for i in range(20):
+            node = tester_node if i % 2 else other_node
+            node.write_data(data="Data " + str(i), chain=blockchain, meta_data="Meta " + str(i % 3))
+
+        query = blockchain.query().meta("Meta 1").node(tester_node.get_node_addr()).heights(1, 20)
+        data = [block.get_data() for block in query]
+
+        self.assertEqual(["Data 1", "Data 7", "Data 13"], data)
+        self.assertEqual(3, query.count())
+        self.assertEqual(["Data 13", "Data 7"], [block.get_data() for block in query.reverse().batches(2).__next__()])
+        self.assertEqual(0, blockchain.query().meta("Not contained inside").count())
+        self.assertEqual(11, blockchain.query().prefix("Data 1").count())
+
+    def test_get_cumulative_work(self):
+
+        tester_node = Node("Tester")
+        blockchain = Blockchain(g_data="Test", diff_threshold=5)
+
+        for i in range(20): tester_node.write_data(data=str(i), chain=blockchain)
+
+        work = sum(2 ** block.get_difficulty() for block in blockchain.get_ledger().values())
+        self.assertEqual(work, blockchain.get_cumulative_work())
+
+        # The Genesis block is mined at difficulty 0:
+        self.assertEqual(1, Blockchain(g_data="Test").get_cumulative_work())
+
+    def test_verify_chain(self):
+
+        tester_node = Node("Tester")
+        blockchain = Blockchain(g_data="Test")
+
+        for i in range(10): tester_node.write_data(data=str(i), chain=blockchain)
+        self.assertTrue(blockchain.verify_chain())
+
+        # Break the link between the blocks 5 and 6:
+        blockchain.get_block_by_index(5).set_block_id(50)
+
+        # Blocks below the verified height are not walked again, until the chain is verified from scratch:
+        self.assertTrue(blockchain.verify_block(blockchain.get_last_block()))
+        self.assertFalse(blockchain.verify_chain())
+        self.assertFalse(blockchain.verify_block(blockchain.get_last_block()))
+
+    def test_validate_chain(self):
+
+        tester_node = Node("Tester")
+        blockchain = Blockchain(g_data="Test")
+
+        for i in range(30): tester_node.write_data(data=str(i), chain=blockchain)
+        self.assertIsNone(blockchain.validate_chain(threads=4))
+
+        # The header still links, but no longer commits to the data:
+        blockchain.get_block_by_index(20).set_data("Tampered")
+        blockchain.get_block_by_index(7).set_meta_data("Tampered")
+
+        self.assertTrue(blockchain.verify_chain())
+        self.assertEqual(7, blockchain.validate_chain(threads=4))
+        self.assertEqual(7, blockchain.validate_chain(threads=1))
+
+    def test_ledger_view(self):
+
+        tester_node = Node("Tester")
+        blockchain = Blockchain(g_data="Test")
+
+        for i in range(10): tester_node.write_data(data=str(i), chain=blockchain)
+        ledger = blockchain.get_ledger()
+
+        self.assertEqual(11, len(ledger))
+        self.assertEqual("Test", ledger[0].get_data())
+        self.assertEqual("9", ledger[-1].get_data())
+        self.assertEqual(["1", "3", "5"], [block.get_data() for block in ledger[2:7:2]])
+        self.assertEqual(["9", "8"], [block.get_data() for block in ledger[:-3:-1]])
+
+        with self.assertRaises(IndexError): ledger[11]
+
+        block_hash = blockchain.get_block_by_index(4).get_block_hash()
+        self.assertEqual("3", ledger[block_hash].get_data())
+        self.assertTrue(block_hash in ledger)
+        self.assertFalse("0" * 64 in ledger)
+        self.assertFalse("z" * 64 in ledger)
+        self.assertFalse("Not a hash" in ledger)
+
+        with self.assertRaises(KeyError): ledger["0" * 64]
+
+        # The view follows the ledger:
+        tester_node.write_data(data="10", chain=blockchain)
+
+        self.assertEqual(12, len(ledger))
+        self.assertEqual([block.get_block_hash() for block in ledger.values()], list(ledger))
+
+    def test_get_blocks_by_meta(self):
+
+        tester_node = Node("Tester")
+        blockchain = Blockchain(g_data="Test")
+
+        for i in range(30): tester_node.write_data(data=str(i), chain=blockchain, meta_data="Meta " + str(i % 3))
+
+        def data(blocks): return [block.get_data() for block in blocks]
+
+        self.assertEqual(10, blockchain.count_blocks_by_meta("Meta 1"))
+        self.assertEqual(["1", "4", "7"], data(blockchain.get_blocks_by_meta("Meta 1", limit=3)))
+        self.assertEqual(["10", "13"], data(blockchain.get_blocks_by_meta("Meta 1", offset=3, limit=2)))
+        self.assertEqual(["28", "25"], data(blockchain.get_blocks_by_meta("Meta 1", limit=2, reverse=True)))
+        self.assertEqual(["1"], data(blockchain.get_blocks_by_meta("Meta 1", offset=9, reverse=True)))
+        self.assertEqual([], blockchain.get_blocks_by_meta("Meta 1", offset=10))
+        self.assertEqual(0, blockchain.count_blocks_by_meta("Not contained inside"))
+        self.assertEqual([], blockchain.get_blocks_by_meta("Not contained inside"))
+
+    def test_set_meta_data_in_ledger(self):
+
+        tester_node = Node("Tester")
+        blockchain = Blockchain(g_data="Test")
+
+        for i in range(3): tester_node.write_data(data=str(i), chain=blockchain, meta_data="Tag A")
+
+        # The index follows tags changed on blocks of the ledger:
+        blockchain.get_block_by_index(1).set_meta_data("Tag B")
+
+        self.assertEqual([2, 3], [block.get_block_id() for block in blockchain.get_blocks_by_meta("Tag A")])
+        self.assertEqual([1], [block.get_block_id() for block in blockchain.get_blocks_by_meta("Tag B")])
+        self.assertEqual([1], [block.get_block_id() for block in blockchain.query().meta("Tag B")])
+
+    def test_interned_tags(self):
+
+        tester_node = Node("Tester")
+        blockchain1 = Blockchain(g_data="Test")
+        blockchain2 = Blockchain(g_data="Test")
+
+        for i in range(10):
+            tester_node.write_data(data=str(i), chain=blockchain1, meta_data="Shared")
+            tester_node.write_data(data=str(i), chain=blockchain2, meta_data="Shared")
+
+        # Blocks share their tags, but changing the tag of one block leaves the others alone:
+        blockchain1.get_block_by_index(3).set_meta_data("Other")
+        blockchain2.get_block_by_index(5).set_node_addr("Other node")
+
+        self.assertEqual({"GENESIS": 1, "Shared": 9, "Other": 1}, blockchain1.count_by_meta())
+        self.assertEqual({"GENESIS": 1, "Shared": 10}, blockchain2.count_by_meta())
+        self.assertEqual(10, blockchain1.count_by_node()[tester_node.get_node_addr()])
+        self.assertEqual(9, blockchain2.count_by_node()[tester_node.get_node_addr()])
+
+        for block in blockchain1.get_blocks_by_range(11):
+            self.assertEqual(blockchain1.get_blockchain_id(), block.get_blockchain_id())
+
+        # Tags are stored once per chain, so a block takes little more than its data:
+        memory = benchmark_block_memory(blocks=20000, data_size=256)
+
+        self.assertTrue(memory["bytes_per_block"] < memory["payload_bytes_per_block"] + memory["sizeof_block"] + 64)
+
 if __name__ == '__main__': unittest.main()
\ No newline at end of file
@@ -0,0 +1,142 @@
+# Copyright 2020 Falk Spickenbaum
+# 
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+# 
+#     http://www.apache.org/licenses/LICENSE-2.0
+# 
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+import hashlib
+from swiftchain import Blockchain, Node, find_trailing_zeros, convert_to_bin
+from swiftchain import set_hash_engine, get_hash_engine, get_hash_engines, cross_check_hash_engines
+
+class TestHashing(unittest.TestCase):
+
+    def tearDown(self):
+
+        set_hash_engine("auto")
+
+    def test_find_trailing_zeros(self):
+
+        self.assertEqual(3, find_trailing_zeros("0001"))
+        self.assertEqual(0, find_trailing_zeros("1000"))
+        self.assertEqual(4, find_trailing_zeros("0000"))
+        self.assertEqual(4, find_trailing_zeros(convert_to_bin("0f")))
+
+        # The zeros of a block hash in binary notation satisfy the difficulty it was mined at:
+        tester_node = Node("Tester")
+        blockchain = Blockchain(g_data="Test")
+        blockchain.set_difficulty(8)
+        tester_node.write_data(data="Data", chain=blockchain)
+
+        block = blockchain.get_last_block()
+        self.assertTrue(find_trailing_zeros(convert_to_bin(block.get_block_hash())) >= block.get_difficulty())
+
+    def test_cross_check_hash_engines(self):
+
+        # Every kernel this CPU supports hashes like PicoSHA2:
+        results = cross_check_hash_engines()
+
+        self.assertEqual(sorted(get_hash_engines()), sorted(results.keys()))
+        self.assertTrue(all(results.values()))
+
+    def test_mine_on_every_engine(self):
+
+        tester_node = Node("Tester")
+        blockchain = Blockchain(g_data="Test")
+        blockchain.set_difficulty(8)
+
+        # The multi-buffer kernels find blocks whose hash is the SHA256 hash of their header,
+        # both on a single thread and on several:
+        for engine in get_hash_engines():
+            set_hash_engine(engine)
+
+            for threads in [1, 4]:
+                tester_node.write_data(data=engine, chain=blockchain, threads=threads)
+                block = blockchain.get_last_block()
+
+                self.assertEqual(engine, block.get_data())
+                self.assertEqual(hashlib.sha256(block.get_header()).hexdigest(), block.get_block_hash())
+
+        set_hash_engine("picosha2")
+        self.assertIsNone(blockchain.validate_chain())
+
+    def test_first_winning_nonce(self):
+
+        blockchain = Blockchain(try_limit=10000000, g_data="Test")
+
+        def leading_zeros(header):
+            return 256 - int.from_bytes(hashlib.sha256(header).digest(), "big").bit_length()
+
+        # A single worker tries the nonces in order, so it finds the first nonce whose hash
+        # satisfies the difficulty. The first word of a digest alone rejects almost every nonce:
+        for engine in get_hash_engines():
+            set_hash_engine(engine)
+
+            for difficulty in [0, 1, 7, 8, 9, 15, 16]:
+                blockchain.set_difficulty(difficulty)
+                block = blockchain.mine_block(data=engine, node_addr="Tester")
+
+                # The nonce is the last field of the header:
+                header = block.get_header()
+                self.assertEqual(block.get_nonce(), int.from_bytes(header[88:], "big"))
+                self.assertEqual(difficulty, block.get_difficulty())
+
+                for nonce in range(block.get_nonce() + 1):
+                    zeros = leading_zeros(header[:88] + nonce.to_bytes(8, "big"))
+                    self.assertEqual(nonce == block.get_nonce(), zeros >= difficulty)
+
+            # From 32 bits on, the first word has to be zero:
+            blockchain.set_difficulty(32)
+            blockchain.set_try_limit(20000)
+            self.assertIsNone(blockchain.mine_block(data=engine, node_addr="Tester"))
+            blockchain.set_try_limit(10000000)
+
+        set_hash_engine("picosha2")
+        self.assertIsNone(blockchain.validate_chain())
+
+    def test_set_hash_engine(self):
+
+        tester_node = Node("Tester")
+        blockchain = Blockchain(g_data="Test")
+        blockchain.set_difficulty(4)
+
+        # Blocks mined on one engine validate on every other engine:
+        for engine in get_hash_engines():
+            set_hash_engine(engine)
+            self.assertEqual(engine, get_hash_engine())
+
+            tester_node.write_data(data=engine, chain=blockchain)
+            self.assertIsNone(blockchain.validate_chain())
+
+        self.assertIn("picosha2", get_hash_engines())
+        self.assertRaises(ValueError, set_hash_engine, "Not an engine")
+
+    def test_get_hash_engine(self):
+
+        set_hash_engine("auto")
+        fastest = get_hash_engine()
+        self.assertIn(fastest, get_hash_engines())
+
+        for engine in get_hash_engines():
+            set_hash_engine(engine)
+            self.assertEqual(engine, get_hash_engine())
+
+            # An engine that cannot be used leaves the one in use unchanged:
+            self.assertRaises(ValueError, set_hash_engine, "")
+            self.assertRaises(ValueError, set_hash_engine, engine.upper() + "x")
+            self.assertEqual(engine, get_hash_engine())
+
+        # "auto" selects the same engine every time:
+        set_hash_engine("auto")
+        self.assertEqual(fastest, get_hash_engine())
+
+
+if __name__ == '__main__': unittest.main()
@@ -96,4 +96,40 @@ class TestNode(unittest.TestCase):
         self.assertEqual("2", blocks[0].get_data())
 
 
+    def test_get_own_blocks(self):
+
+        tester_node = Node("Tester")
+        other_node = Node("Other")
+        blockchain = Blockchain(g_data="Test")
+
+        for i in range(20):
+            node = tester_node if i % 4 else other_node
+            node.write_data(data=str(i), chain=blockchain)
+
+        def data(blocks): return [block.get_data() for block in blocks]
+
+        self.assertEqual(15, tester_node.count_own_blocks(chain=blockchain))
+        self.assertEqual(5, blockchain.count_blocks_by_node(other_node.get_node_addr()))
+        self.assertEqual(["1", "2", "3"], data(tester_node.get_own_blocks(chain=blockchain, limit=3)))
+        self.assertEqual(["18", "17"], data(tester_node.get_own_blocks(chain=blockchain, offset=1, limit=2, reverse=True)))
+        self.assertEqual(["8", "12"], data(blockchain.get_blocks_by_node(other_node.get_node_addr(), offset=2, limit=2)))
+        self.assertEqual([], blockchain.get_blocks_by_node("Not contained inside"))
+
+    def test_set_node_addr_in_ledger(self):
+
+        tester_node = Node("Tester")
+        other_node = Node("Other")
+        blockchain = Blockchain(g_data="Test")
+
+        for i in range(3): tester_node.write_data(data=str(i), chain=blockchain)
+
+        # The index follows addresses changed on blocks of the ledger:
+        blockchain.get_block_by_index(2).set_node_addr(other_node.get_node_addr())
+
+        self.assertEqual(2, tester_node.count_own_blocks(chain=blockchain))
+        self.assertEqual(["0", "2"], [block.get_data() for block in tester_node.get_own_blocks(chain=blockchain)])
+        self.assertEqual(1, blockchain.count_blocks_by_node(other_node.get_node_addr()))
+        self.assertEqual(["1"], [block.get_data() for block in other_node.get_own_blocks(chain=blockchain)])
+
+
 if __name__ == '__main__': unittest.main()